@@ -146,6 +146,11 @@ ifneq ($(FORCE_LAYOUT),)
     TARGET := $(TARGET)_$(FORCE_LAYOUT)
 endif
 
+ifeq ($(strip $(SIMULATOR)), yes)
+    TARGET := $(TARGET)_sim
+    KEYBOARD_OUTPUT := $(KEYBOARD_OUTPUT)_sim
+endif
+
 include quantum/mcu_selection.mk
 
 ifdef MCU_FAMILY
@@ -230,7 +235,11 @@ endif
 # Determine and set parameters based on the keyboard's processor family.
 # We can assume a ChibiOS target When MCU_FAMILY is defined since it's
 # not used for LUFA
-ifdef MCU_FAMILY
+ifeq ($(strip $(SIMULATOR)), yes)
+    PLATFORM=TEST
+    PLATFORM_KEY=test
+    FIRMWARE_FORMAT=elf
+else ifdef MCU_FAMILY
     PLATFORM=CHIBIOS
     PLATFORM_KEY=chibios
     FIRMWARE_FORMAT?=bin
@@ -307,6 +316,18 @@ SRC += $(KEYBOARD_SRC) \
 # Optimize size but this may cause error "relocation truncated to fit"
 #EXTRALDFLAGS = -Wl,--relax
 
+# The simulator supplies the matrix and the LED drivers itself, and has
+# nothing behind the features that talk to other hardware
+ifeq ($(strip $(SIMULATOR)), yes)
+    PROTOCOL := SIMULATOR
+    CUSTOM_MATRIX := lite
+    WS2812_DRIVER := custom
+    BACKLIGHT_DRIVER := custom
+    EEPROM_DRIVER := vendor
+    SPLIT_KEYBOARD := no
+    $(foreach FEATURE,AUDIO BLUETOOTH CONSOLE HAPTIC MIDI OLED_DRIVER POINTING_DEVICE PS2_MOUSE RAW SERIAL_LINK STENO VIA VIRTSER VISUALIZER,$(eval $(FEATURE)_ENABLE := no))
+endif
+
 # Search Path
 VPATH += $(KEYMAP_PATH)
 VPATH += $(USER_PATH)
@@ -318,6 +339,11 @@ include $(TMK_PATH)/protocol.mk
 include $(TMK_PATH)/common.mk
 include bootloader.mk
 
+ifeq ($(strip $(SIMULATOR)), yes)
+    # Drop the keyboard's own matrix, the simulator's replaces it
+    SRC := $(filter-out matrix.c %/matrix.c,$(SRC))
+endif
+
 SRC += $(patsubst %.c,%.clib,$(LIB_SRC))
 SRC += $(patsubst %.c,%.clib,$(QUANTUM_LIB_SRC))
 SRC += $(TMK_COMMON_SRC)
@@ -360,6 +386,10 @@ $(KEYBOARD_OUTPUT)_CONFIG := $(PROJECT_CONFIG)
 
 # Default target.
 all: build check-size
+ifeq ($(strip $(OBJ_CACHE)), yes)
+all: objcache-report
+objcache-report: build
+endif
 build: elf cpfirmware
 check-size: build
 objs-size: build
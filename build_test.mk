@@ -50,6 +50,14 @@ endif
 include common_features.mk
 include $(TMK_PATH)/common.mk
 include $(QUANTUM_PATH)/serial_link/tests/rules.mk
+include $(QUANTUM_PATH)/audio/tests/rules.mk
+include $(QUANTUM_PATH)/tests/rules.mk
+include $(QUANTUM_PATH)/visualizer/tests/rules.mk
+include $(DRIVER_PATH)/i2c_queue/tests/rules.mk
+include $(DRIVER_PATH)/oled/tests/rules.mk
+include $(DRIVER_PATH)/eeprom/tests/rules.mk
+include $(TMK_PATH)/protocol/tests/rules.mk
+include $(TMK_PATH)/common/tests/rules.mk
 ifneq ($(filter $(FULL_TESTS),$(TEST)),)
 include build_full_test.mk
 endif
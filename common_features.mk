@@ -36,6 +36,9 @@ ifeq ($(strip $(AUDIO_ENABLE)), yes)
     SRC += $(QUANTUM_DIR)/audio/audio_$(PLATFORM_KEY).c
     SRC += $(QUANTUM_DIR)/audio/voices.c
     SRC += $(QUANTUM_DIR)/audio/luts.c
+    ifeq ($(PLATFORM_KEY),chibios)
+        SRC += $(QUANTUM_DIR)/audio/synth.c
+    endif
 endif
 
 ifeq ($(strip $(MIDI_ENABLE)), yes)
@@ -277,7 +280,7 @@ ifeq ($(strip $(BACKLIGHT_ENABLE)), yes)
     endif
 endif
 
-VALID_WS2812_DRIVER_TYPES := bitbang pwm spi i2c
+VALID_WS2812_DRIVER_TYPES := bitbang pwm spi i2c custom
 
 WS2812_DRIVER ?= bitbang
 ifeq ($(strip $(WS2812_DRIVER_REQUIRED)), yes)
@@ -289,6 +292,8 @@ ifeq ($(strip $(WS2812_DRIVER_REQUIRED)), yes)
 
     ifeq ($(strip $(WS2812_DRIVER)), bitbang)
         SRC += ws2812.c
+    else ifeq ($(strip $(WS2812_DRIVER)), custom)
+        # ws2812_setleds() is provided by the keyboard
     else
         SRC += ws2812_$(strip $(WS2812_DRIVER)).c
     endif
@@ -442,6 +447,13 @@ ifeq ($(strip $(OLED_DRIVER_ENABLE)), yes)
     SRC += oled_driver.c
 endif
 
+ifeq ($(strip $(I2C_QUEUE_ENABLE)), yes)
+    OPT_DEFS += -DI2C_QUEUE_ENABLE
+    COMMON_VPATH += $(DRIVER_PATH)/i2c_queue
+    QUANTUM_LIB_SRC += i2c_master.c
+    SRC += i2c_queue.c
+endif
+
 include $(DRIVER_PATH)/qwiic/qwiic.mk
 
 ifeq ($(strip $(UCIS_ENABLE)), yes)
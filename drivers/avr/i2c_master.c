@@ -23,6 +23,9 @@
 #include "i2c_master.h"
 #include "timer.h"
 #include "wait.h"
+#ifdef I2C_QUEUE_ENABLE
+#    include "i2c_queue.h"
+#endif
 
 #ifndef F_SCL
 #    define F_SCL 400000UL  // SCL frequency
@@ -222,3 +225,43 @@ void i2c_stop(void) {
     // transmit STOP condition
     TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWSTO);
 }
+
+#ifdef I2C_QUEUE_ENABLE
+/* The TWI peripheral is driven by polling, so queued jobs run to completion
+ * right here. Segments are written straight from the caller's buffers.
+ */
+void i2c_queue_bus_start(i2c_job_t* job) {
+    i2c_status_t status = I2C_STATUS_SUCCESS;
+
+    if (job->num_segments > 0) {
+        status = i2c_start(job->address | I2C_WRITE, job->timeout);
+        for (uint8_t s = 0; s < job->num_segments && status >= 0; s++) {
+            for (uint16_t i = 0; i < job->segments[s].length && status >= 0; i++) {
+                status = i2c_write(job->segments[s].data[i], job->timeout);
+            }
+        }
+    }
+
+    if (job->rx_length > 0 && status >= 0) {
+        status = i2c_start(job->address | I2C_READ, job->timeout);
+
+        for (uint16_t i = 0; i < (job->rx_length - 1) && status >= 0; i++) {
+            status = i2c_read_ack(job->timeout);
+            if (status >= 0) {
+                job->rx_data[i] = status;
+            }
+        }
+
+        if (status >= 0) {
+            status = i2c_read_nack(job->timeout);
+            if (status >= 0) {
+                job->rx_data[(job->rx_length - 1)] = status;
+            }
+        }
+    }
+
+    i2c_stop();
+
+    i2c_queue_bus_complete((status < 0) ? status : I2C_STATUS_SUCCESS);
+}
+#endif
@@ -28,6 +28,9 @@
 #include "i2c_master.h"
 #include <string.h>
 #include <hal.h>
+#ifdef I2C_QUEUE_ENABLE
+#    include "i2c_queue.h"
+#endif
 
 static uint8_t i2c_address;
 
@@ -55,6 +58,27 @@ static i2c_status_t chibios_to_qmk(const msg_t* status) {
     }
 }
 
+// A timeout leaves the driver locked and an error can leave the peripheral in
+// a bad state, so the driver is restarted after anything but success
+static i2c_status_t i2c_transfer_result(msg_t status) {
+    if (status != MSG_OK) {
+        i2cStop(&I2C_DRIVER);
+        i2cStart(&I2C_DRIVER, &i2cconfig);
+    }
+    return chibios_to_qmk(&status);
+}
+
+// i2cStart() reconfigures the peripheral every time it is called, so only do
+// it when the driver has actually been stopped
+static void i2c_driver_start(void) {
+#ifdef I2C_QUEUE_ENABLE
+    i2c_queue_wait_idle();
+#endif
+    if (I2C_DRIVER.state == I2C_STOP) {
+        i2cStart(&I2C_DRIVER, &i2cconfig);
+    }
+}
+
 __attribute__((weak)) void i2c_init(void) {
     // Try releasing special pins for a short time
     palSetPadMode(I2C1_SCL_BANK, I2C1_SCL, PAL_MODE_INPUT);
@@ -72,43 +96,112 @@ __attribute__((weak)) void i2c_init(void) {
 
 i2c_status_t i2c_start(uint8_t address) {
     i2c_address = address;
-    i2cStart(&I2C_DRIVER, &i2cconfig);
+    i2c_driver_start();
     return I2C_STATUS_SUCCESS;
 }
 
 i2c_status_t i2c_transmit(uint8_t address, const uint8_t* data, uint16_t length, uint16_t timeout) {
     i2c_address = address;
-    i2cStart(&I2C_DRIVER, &i2cconfig);
+    i2c_driver_start();
     msg_t status = i2cMasterTransmitTimeout(&I2C_DRIVER, (i2c_address >> 1), data, length, 0, 0, TIME_MS2I(timeout));
-    return chibios_to_qmk(&status);
+    return i2c_transfer_result(status);
 }
 
 i2c_status_t i2c_receive(uint8_t address, uint8_t* data, uint16_t length, uint16_t timeout) {
     i2c_address = address;
-    i2cStart(&I2C_DRIVER, &i2cconfig);
+    i2c_driver_start();
     msg_t status = i2cMasterReceiveTimeout(&I2C_DRIVER, (i2c_address >> 1), data, length, TIME_MS2I(timeout));
-    return chibios_to_qmk(&status);
+    return i2c_transfer_result(status);
 }
 
 i2c_status_t i2c_writeReg(uint8_t devaddr, uint8_t regaddr, const uint8_t* data, uint16_t length, uint16_t timeout) {
     i2c_address = devaddr;
-    i2cStart(&I2C_DRIVER, &i2cconfig);
+    i2c_driver_start();
 
     uint8_t complete_packet[length + 1];
-    for (uint8_t i = 0; i < length; i++) {
-        complete_packet[i + 1] = data[i];
-    }
     complete_packet[0] = regaddr;
+    memcpy(&complete_packet[1], data, length);
 
     msg_t status = i2cMasterTransmitTimeout(&I2C_DRIVER, (i2c_address >> 1), complete_packet, length + 1, 0, 0, TIME_MS2I(timeout));
-    return chibios_to_qmk(&status);
+    return i2c_transfer_result(status);
 }
 
 i2c_status_t i2c_readReg(uint8_t devaddr, uint8_t regaddr, uint8_t* data, uint16_t length, uint16_t timeout) {
     i2c_address = devaddr;
-    i2cStart(&I2C_DRIVER, &i2cconfig);
+    i2c_driver_start();
     msg_t status = i2cMasterTransmitTimeout(&I2C_DRIVER, (i2c_address >> 1), &regaddr, 1, data, length, TIME_MS2I(timeout));
-    return chibios_to_qmk(&status);
+    return i2c_transfer_result(status);
+}
+
+void i2c_stop(void) {
+#ifdef I2C_QUEUE_ENABLE
+    i2c_queue_wait_idle();
+#endif
+    i2cStop(&I2C_DRIVER);
 }
 
-void i2c_stop(void) { i2cStop(&I2C_DRIVER); }
+#ifdef I2C_QUEUE_ENABLE
+/* Queued jobs are run by a dedicated thread, which sleeps in the HAL while
+ * the transfer is in progress and lets the main loop carry on scanning.
+ * Jobs with more than one segment are gathered into a static buffer first,
+ * since the DMA transfer needs contiguous data; this happens in the worker
+ * thread, not in the caller.
+ */
+static uint8_t            i2c_queue_buffer[I2C_QUEUE_BUFFER_SIZE];
+static i2c_job_t* volatile i2c_queue_job;
+static binary_semaphore_t i2c_queue_semaphore;
+// The transfer call chain through the HAL doesn't fit in 128 bytes
+static THD_WORKING_AREA(waI2cQueueThread, 256);
+
+static i2c_status_t i2c_queue_run(i2c_job_t* job) {
+    const uint8_t* tx_data   = NULL;
+    size_t         tx_length = 0;
+
+    if (job->num_segments == 1) {
+        tx_data   = job->segments[0].data;
+        tx_length = job->segments[0].length;
+    } else if (job->num_segments > 1) {
+        for (uint8_t i = 0; i < job->num_segments; i++) {
+            if (tx_length + job->segments[i].length > sizeof(i2c_queue_buffer)) {
+                return I2C_STATUS_ERROR;
+            }
+            memcpy(&i2c_queue_buffer[tx_length], job->segments[i].data, job->segments[i].length);
+            tx_length += job->segments[i].length;
+        }
+        tx_data = i2c_queue_buffer;
+    }
+
+    msg_t status;
+    if (tx_length > 0) {
+        status = i2cMasterTransmitTimeout(&I2C_DRIVER, (job->address >> 1), tx_data, tx_length, job->rx_data, job->rx_length, TIME_MS2I(job->timeout));
+    } else {
+        status = i2cMasterReceiveTimeout(&I2C_DRIVER, (job->address >> 1), job->rx_data, job->rx_length, TIME_MS2I(job->timeout));
+    }
+    return i2c_transfer_result(status);
+}
+
+static THD_FUNCTION(I2cQueueThread, arg) {
+    (void)arg;
+    chRegSetThreadName("i2c_queue");
+
+    while (true) {
+        chBSemWait(&i2c_queue_semaphore);
+        i2c_queue_bus_complete(i2c_queue_run(i2c_queue_job));
+    }
+}
+
+void i2c_queue_bus_start(i2c_job_t* job) {
+    static bool thread_started = false;
+    if (!thread_started) {
+        chBSemObjectInit(&i2c_queue_semaphore, true);
+        chThdCreateStatic(waI2cQueueThread, sizeof(waI2cQueueThread), NORMALPRIO + 1, I2cQueueThread, NULL);
+        thread_started = true;
+    }
+
+    if (I2C_DRIVER.state == I2C_STOP) {
+        i2cStart(&I2C_DRIVER, &i2cconfig);
+    }
+    i2c_queue_job = job;
+    chBSemSignal(&i2c_queue_semaphore);
+}
+#endif
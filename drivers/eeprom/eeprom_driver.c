@@ -19,6 +19,11 @@
 
 #include "eeprom_driver.h"
 
+// Drivers that write straight through have nothing to do here
+__attribute__((weak)) void eeprom_driver_task(void) {}
+
+__attribute__((weak)) void eeprom_driver_flush(void) {}
+
 uint8_t eeprom_read_byte(const uint8_t *addr) {
     uint8_t ret;
     eeprom_read_block(&ret, addr, 1);
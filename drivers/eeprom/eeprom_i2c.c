@@ -30,9 +30,11 @@
     there is nothing to override during linkage.
 */
 
+#include "timer.h"
 #include "wait.h"
 #include "i2c_master.h"
 #include "eeprom.h"
+#include "eeprom_driver.h"
 #include "eeprom_i2c.h"
 
 // #define DEBUG_EEPROM_OUTPUT
@@ -41,6 +43,31 @@
 #    include "print.h"
 #endif  // DEBUG_EEPROM_OUTPUT
 
+/*
+    Writes are collected in RAM, one buffer per EEPROM page, and written out
+    from eeprom_driver_task() once a page has been left alone for
+    EXTERNAL_EEPROM_COMMIT_DELAY. Consecutive writes to the same page are
+    merged into a single page write, so the keyboard doesn't stall for a write
+    cycle after every few bytes.
+
+    Each buffer holds one contiguous run of bytes within its page. Reads are
+    patched with whatever is still waiting in the buffers.
+*/
+typedef struct {
+    intptr_t page;        // address of the first byte in the page
+    uint16_t start;       // offset of the first buffered byte
+    uint16_t end;         // offset after the last buffered byte, start == end when unused
+    uint16_t last_write;  // timer value of the last change
+    uint8_t  data[EXTERNAL_EEPROM_PAGE_SIZE];
+} eeprom_page_t;
+
+static eeprom_page_t pages[EXTERNAL_EEPROM_WRITE_BUFFER_PAGES];
+
+// The device is busy with a write cycle started at write_start
+static bool     write_pending = false;
+static uint16_t write_start;
+static intptr_t write_page;
+
 static inline void init_i2c_if_required(void) {
     static int done = 0;
     if (!done) {
@@ -57,23 +84,195 @@ static inline void fill_target_address(uint8_t *buffer, const void *addr) {
     }
 }
 
-void eeprom_driver_init(void) {}
+/*
+    The EEPROM doesn't acknowledge its address until the write cycle is over,
+    so polling it returns as soon as the page has been written instead of
+    always waiting for the worst case EXTERNAL_EEPROM_WRITE_TIME.
+*/
+static bool device_ready(void) {
+    if (!write_pending) {
+        return true;
+    }
+
+    if (timer_elapsed(write_start) > EXTERNAL_EEPROM_WRITE_TIME) {
+        write_pending = false;
+        return true;
+    }
+
+    // Only sets the address pointer, a write without data doesn't start a write cycle
+    uint8_t address[EXTERNAL_EEPROM_ADDRESS_SIZE];
+    fill_target_address(address, (const void *)write_page);
+    if (i2c_transmit(EXTERNAL_EEPROM_I2C_ADDRESS(write_page), address, EXTERNAL_EEPROM_ADDRESS_SIZE, 100) == I2C_STATUS_SUCCESS) {
+        write_pending = false;
+    }
+    return !write_pending;
+}
+
+// Gives up once EXTERNAL_EEPROM_WRITE_TIME is over, polling every 100us rather than keeping the bus busy
+static void wait_ready(void) {
+    while (!device_ready()) {
+        wait_us(100);
+    }
+}
+
+static void write_page_data(intptr_t target_addr, const uint8_t *data, uint16_t len) {
+    uint8_t complete_packet[EXTERNAL_EEPROM_ADDRESS_SIZE + EXTERNAL_EEPROM_PAGE_SIZE];
+
+    fill_target_address(complete_packet, (const void *)target_addr);
+    memcpy(&complete_packet[EXTERNAL_EEPROM_ADDRESS_SIZE], data, len);
+
+#ifdef DEBUG_EEPROM_OUTPUT
+    dprintf("[EEPROM W] 0x%04X: ", ((int)target_addr));
+    for (uint16_t i = 0; i < len; i++) {
+        dprintf(" %02X", (int)(data[i]));
+    }
+    dprintf("\n");
+#endif  // DEBUG_EEPROM_OUTPUT
+
+    wait_ready();
+    i2c_transmit(EXTERNAL_EEPROM_I2C_ADDRESS(target_addr), complete_packet, EXTERNAL_EEPROM_ADDRESS_SIZE + len, 100);
+    if (EXTERNAL_EEPROM_WRITE_TIME > 0) {
+        write_pending = true;
+        write_start   = timer_read();
+        write_page    = target_addr - target_addr % EXTERNAL_EEPROM_PAGE_SIZE;
+    }
+}
+
+static void read_device(void *buf, intptr_t addr, size_t len) {
+    uint8_t complete_packet[EXTERNAL_EEPROM_ADDRESS_SIZE];
+    fill_target_address(complete_packet, (const void *)addr);
+
+    wait_ready();
+    i2c_transmit(EXTERNAL_EEPROM_I2C_ADDRESS(addr), complete_packet, EXTERNAL_EEPROM_ADDRESS_SIZE, 100);
+    i2c_receive(EXTERNAL_EEPROM_I2C_ADDRESS(addr), buf, len, 100);
+}
+
+static void commit_page(eeprom_page_t *page) {
+    write_page_data(page->page + page->start, &page->data[page->start], page->end - page->start);
+    page->start = page->end = 0;
+}
+
+static eeprom_page_t *find_page(intptr_t page_addr) {
+    for (uint8_t i = 0; i < EXTERNAL_EEPROM_WRITE_BUFFER_PAGES; i++) {
+        if (pages[i].start != pages[i].end && pages[i].page == page_addr) {
+            return &pages[i];
+        }
+    }
+    return NULL;
+}
+
+// Returns an unused buffer for page_addr, committing the least recently changed one if they are all in use
+static eeprom_page_t *allocate_page(intptr_t page_addr) {
+    eeprom_page_t *page = &pages[0];
+    for (uint8_t i = 0; i < EXTERNAL_EEPROM_WRITE_BUFFER_PAGES; i++) {
+        if (pages[i].start == pages[i].end) {
+            page = &pages[i];
+            break;
+        }
+        if (timer_elapsed(pages[i].last_write) > timer_elapsed(page->last_write)) {
+            page = &pages[i];
+        }
+    }
+
+    if (page->start != page->end) {
+        commit_page(page);
+    }
+    page->page = page_addr;
+    return page;
+}
+
+// Adds len bytes at offset to the buffered run, reading in any gap between them
+static void merge_page(eeprom_page_t *page, uint16_t offset, const uint8_t *data, uint16_t len) {
+    uint16_t end = offset + len;
+    if (page->start == page->end) {
+        page->start = offset;
+        page->end   = end;
+    } else {
+        if (offset > page->end) {
+            read_device(&page->data[page->end], page->page + page->end, offset - page->end);
+        }
+        if (end < page->start) {
+            read_device(&page->data[end], page->page + end, page->start - end);
+        }
+        if (offset < page->start) {
+            page->start = offset;
+        }
+        if (end > page->end) {
+            page->end = end;
+        }
+    }
+
+    memcpy(&page->data[offset], data, len);
+    page->last_write = timer_read();
+}
+
+void eeprom_driver_init(void) {
+    for (uint8_t i = 0; i < EXTERNAL_EEPROM_WRITE_BUFFER_PAGES; i++) {
+        pages[i].start = pages[i].end = 0;
+    }
+}
 
 void eeprom_driver_erase(void) {
     uint8_t buf[EXTERNAL_EEPROM_PAGE_SIZE];
     memset(buf, 0x00, EXTERNAL_EEPROM_PAGE_SIZE);
+
+    // Anything still buffered would be erased anyway
+    eeprom_driver_init();
+    init_i2c_if_required();
     for (intptr_t addr = 0; addr < EXTERNAL_EEPROM_BYTE_COUNT; addr += EXTERNAL_EEPROM_PAGE_SIZE) {
-        eeprom_write_block(buf, (void *)addr, EXTERNAL_EEPROM_PAGE_SIZE);
+        write_page_data(addr, buf, EXTERNAL_EEPROM_PAGE_SIZE);
+    }
+}
+
+// Commits one page that hasn't changed for a while, if the device isn't still busy with the last one
+void eeprom_driver_task(void) {
+    eeprom_page_t *page = NULL;
+    for (uint8_t i = 0; i < EXTERNAL_EEPROM_WRITE_BUFFER_PAGES; i++) {
+        if (pages[i].start != pages[i].end && timer_elapsed(pages[i].last_write) >= EXTERNAL_EEPROM_COMMIT_DELAY) {
+            if (page == NULL || timer_elapsed(pages[i].last_write) > timer_elapsed(page->last_write)) {
+                page = &pages[i];
+            }
+        }
     }
+
+    if (page != NULL && device_ready()) {
+        commit_page(page);
+    }
+}
+
+void eeprom_driver_flush(void) {
+    for (uint8_t i = 0; i < EXTERNAL_EEPROM_WRITE_BUFFER_PAGES; i++) {
+        if (pages[i].start != pages[i].end) {
+            commit_page(&pages[i]);
+        }
+    }
+    wait_ready();
 }
 
 void eeprom_read_block(void *buf, const void *addr, size_t len) {
-    uint8_t complete_packet[EXTERNAL_EEPROM_ADDRESS_SIZE];
-    fill_target_address(complete_packet, addr);
+    intptr_t target_addr = (intptr_t)addr;
 
     init_i2c_if_required();
-    i2c_transmit(EXTERNAL_EEPROM_I2C_ADDRESS((intptr_t)addr), complete_packet, EXTERNAL_EEPROM_ADDRESS_SIZE, 100);
-    i2c_receive(EXTERNAL_EEPROM_I2C_ADDRESS((intptr_t)addr), buf, len, 100);
+    read_device(buf, target_addr, len);
+
+    // Patch in anything that hasn't been written yet
+    for (uint8_t i = 0; i < EXTERNAL_EEPROM_WRITE_BUFFER_PAGES; i++) {
+        eeprom_page_t *page = &pages[i];
+        if (page->start == page->end) {
+            continue;
+        }
+        intptr_t start = page->page + page->start;
+        intptr_t end   = page->page + page->end;
+        if (start < target_addr) {
+            start = target_addr;
+        }
+        if (end > target_addr + (intptr_t)len) {
+            end = target_addr + len;
+        }
+        if (start < end) {
+            memcpy((uint8_t *)buf + (start - target_addr), &page->data[start - page->page], end - start);
+        }
+    }
 
 #ifdef DEBUG_EEPROM_OUTPUT
     dprintf("[EEPROM R] 0x%04X: ", ((int)addr));
@@ -85,33 +284,23 @@ void eeprom_read_block(void *buf, const void *addr, size_t len) {
 }
 
 void eeprom_write_block(const void *buf, void *addr, size_t len) {
-    uint8_t  complete_packet[EXTERNAL_EEPROM_ADDRESS_SIZE + EXTERNAL_EEPROM_PAGE_SIZE];
-    uint8_t *read_buf    = (uint8_t *)buf;
-    intptr_t target_addr = (intptr_t)addr;
+    const uint8_t *read_buf    = (const uint8_t *)buf;
+    intptr_t       target_addr = (intptr_t)addr;
 
     init_i2c_if_required();
     while (len > 0) {
         intptr_t page_offset  = target_addr % EXTERNAL_EEPROM_PAGE_SIZE;
-        int      write_length = EXTERNAL_EEPROM_PAGE_SIZE - page_offset;
+        intptr_t page_addr    = target_addr - page_offset;
+        size_t   write_length = EXTERNAL_EEPROM_PAGE_SIZE - page_offset;
         if (write_length > len) {
             write_length = len;
         }
 
-        fill_target_address(complete_packet, (const void *)target_addr);
-        for (uint8_t i = 0; i < write_length; i++) {
-            complete_packet[EXTERNAL_EEPROM_ADDRESS_SIZE + i] = read_buf[i];
+        eeprom_page_t *page = find_page(page_addr);
+        if (page == NULL) {
+            page = allocate_page(page_addr);
         }
-
-#ifdef DEBUG_EEPROM_OUTPUT
-        dprintf("[EEPROM W] 0x%04X: ", ((int)target_addr));
-        for (uint8_t i = 0; i < write_length; i++) {
-            dprintf(" %02X", (int)(read_buf[i]));
-        }
-        dprintf("\n");
-#endif  // DEBUG_EEPROM_OUTPUT
-
-        i2c_transmit(EXTERNAL_EEPROM_I2C_ADDRESS((intptr_t)addr), complete_packet, EXTERNAL_EEPROM_ADDRESS_SIZE + write_length, 100);
-        wait_ms(EXTERNAL_EEPROM_WRITE_TIME);
+        merge_page(page, page_offset, read_buf, write_length);
 
         read_buf += write_length;
         target_addr += write_length;
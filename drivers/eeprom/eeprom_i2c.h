@@ -113,3 +113,19 @@
 #ifndef EXTERNAL_EEPROM_WRITE_TIME
 #    define EXTERNAL_EEPROM_WRITE_TIME 5
 #endif
+
+/*
+    The number of pages that writes are collected in before they are written
+    to the EEPROM. Each one takes EXTERNAL_EEPROM_PAGE_SIZE bytes of RAM.
+*/
+#ifndef EXTERNAL_EEPROM_WRITE_BUFFER_PAGES
+#    define EXTERNAL_EEPROM_WRITE_BUFFER_PAGES 2
+#endif
+
+/*
+    How long in milliseconds a page has to be left alone before it is written
+    to the EEPROM, so that a run of small writes ends up in one page write.
+*/
+#ifndef EXTERNAL_EEPROM_COMMIT_DELAY
+#    define EXTERNAL_EEPROM_COMMIT_DELAY 10
+#endif
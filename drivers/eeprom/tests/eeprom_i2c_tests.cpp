@@ -0,0 +1,217 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include <cstdlib>
+#include <vector>
+extern "C" {
+#include "eeprom_driver.h"
+#include "eeprom_i2c.h"
+#include "i2c_master.h"
+#include "timer.h"
+
+void set_time(uint32_t t);
+void advance_time(uint32_t ms);
+}
+
+// Simulated 24xx EEPROM: it doesn't acknowledge anything while a write cycle
+// is in progress, and every poll takes a bit of bus time
+static const uint32_t device_write_time = 2;
+
+struct page_write_t {
+    uint16_t address;
+    uint16_t length;
+};
+
+static std::vector<uint8_t>      memory;
+static std::vector<page_write_t> page_writes;
+static uint16_t                  pointer;
+static uint32_t                  busy_until;
+
+extern "C" {
+void i2c_init(void) {}
+
+i2c_status_t i2c_transmit(uint8_t address, const uint8_t* data, uint16_t length, uint16_t timeout) {
+    EXPECT_EQ(address, EXTERNAL_EEPROM_I2C_BASE_ADDRESS);
+    EXPECT_GE(length, EXTERNAL_EEPROM_ADDRESS_SIZE);
+    if (timer_read32() < busy_until) {
+        advance_time(1);
+        return I2C_STATUS_ERROR;
+    }
+
+    pointer = data[0] << 8 | data[1];
+    if (length > EXTERNAL_EEPROM_ADDRESS_SIZE) {
+        uint16_t page = pointer - pointer % EXTERNAL_EEPROM_PAGE_SIZE;
+        // Writes wrap around within the page, they must not cross into the next one
+        EXPECT_LE(pointer % EXTERNAL_EEPROM_PAGE_SIZE + length - EXTERNAL_EEPROM_ADDRESS_SIZE, EXTERNAL_EEPROM_PAGE_SIZE);
+        for (uint16_t i = 0; i < length - EXTERNAL_EEPROM_ADDRESS_SIZE; i++) {
+            memory[page + (pointer + i) % EXTERNAL_EEPROM_PAGE_SIZE] = data[EXTERNAL_EEPROM_ADDRESS_SIZE + i];
+        }
+        page_writes.push_back({pointer, (uint16_t)(length - EXTERNAL_EEPROM_ADDRESS_SIZE)});
+        busy_until = timer_read32() + device_write_time;
+    }
+    return I2C_STATUS_SUCCESS;
+}
+
+i2c_status_t i2c_receive(uint8_t address, uint8_t* data, uint16_t length, uint16_t timeout) {
+    EXPECT_EQ(address, EXTERNAL_EEPROM_I2C_BASE_ADDRESS);
+    EXPECT_GE(timer_read32(), busy_until);
+    for (uint16_t i = 0; i < length; i++) {
+        data[i] = memory[(pointer + i) % EXTERNAL_EEPROM_BYTE_COUNT];
+    }
+    return I2C_STATUS_SUCCESS;
+}
+}
+
+class EepromI2c : public testing::Test {
+   public:
+    EepromI2c() {
+        set_time(0);
+        memory.assign(EXTERNAL_EEPROM_BYTE_COUNT, 0xFF);
+        page_writes.clear();
+        busy_until = 0;
+        eeprom_driver_init();
+    }
+
+    void write(uint16_t address, std::vector<uint8_t> data) { eeprom_write_block(data.data(), (void*)(intptr_t)address, data.size()); }
+
+    std::vector<uint8_t> read(uint16_t address, uint16_t length) {
+        std::vector<uint8_t> data(length);
+        eeprom_read_block(data.data(), (const void*)(intptr_t)address, length);
+        return data;
+    }
+
+    // Runs the main loop for time ms
+    void run(uint32_t time) {
+        for (uint32_t i = 0; i < time; i++) {
+            advance_time(1);
+            eeprom_driver_task();
+        }
+    }
+};
+
+TEST_F(EepromI2c, reads_back_buffered_writes) {
+    write(10, {1, 2, 3});
+    EXPECT_EQ(read(8, 7), std::vector<uint8_t>({0xFF, 0xFF, 1, 2, 3, 0xFF, 0xFF}));
+    EXPECT_TRUE(page_writes.empty());
+}
+
+TEST_F(EepromI2c, commits_from_the_task) {
+    write(10, {1, 2, 3});
+    run(EXTERNAL_EEPROM_COMMIT_DELAY - 1);
+    EXPECT_TRUE(page_writes.empty());
+
+    run(1);
+    ASSERT_EQ(page_writes.size(), 1);
+    EXPECT_EQ(page_writes[0].address, 10);
+    EXPECT_EQ(page_writes[0].length, 3);
+    EXPECT_EQ(memory[10], 1);
+    EXPECT_EQ(memory[12], 3);
+    EXPECT_EQ(read(10, 3), std::vector<uint8_t>({1, 2, 3}));
+}
+
+TEST_F(EepromI2c, merges_writes_to_a_page) {
+    for (uint16_t i = 0; i < EXTERNAL_EEPROM_PAGE_SIZE; i++) {
+        eeprom_write_byte((uint8_t*)(intptr_t)(EXTERNAL_EEPROM_PAGE_SIZE + i), i);
+        advance_time(1);
+    }
+    run(EXTERNAL_EEPROM_COMMIT_DELAY);
+
+    ASSERT_EQ(page_writes.size(), 1);
+    EXPECT_EQ(page_writes[0].address, EXTERNAL_EEPROM_PAGE_SIZE);
+    EXPECT_EQ(page_writes[0].length, EXTERNAL_EEPROM_PAGE_SIZE);
+}
+
+TEST_F(EepromI2c, fills_gaps_between_writes) {
+    memory[3] = 0x33;
+    write(1, {1});
+    write(5, {5});
+    run(EXTERNAL_EEPROM_COMMIT_DELAY);
+
+    ASSERT_EQ(page_writes.size(), 1);
+    EXPECT_EQ(page_writes[0].address, 1);
+    EXPECT_EQ(page_writes[0].length, 5);
+    EXPECT_EQ(std::vector<uint8_t>(memory.begin(), memory.begin() + 7), std::vector<uint8_t>({0xFF, 1, 0xFF, 0x33, 0xFF, 5, 0xFF}));
+}
+
+TEST_F(EepromI2c, splits_writes_at_page_boundaries) {
+    std::vector<uint8_t> data(EXTERNAL_EEPROM_PAGE_SIZE, 0x42);
+    write(EXTERNAL_EEPROM_PAGE_SIZE / 2, data);
+    run(EXTERNAL_EEPROM_COMMIT_DELAY * 2);
+
+    ASSERT_EQ(page_writes.size(), 2);
+    EXPECT_EQ(read(EXTERNAL_EEPROM_PAGE_SIZE / 2, EXTERNAL_EEPROM_PAGE_SIZE), data);
+}
+
+TEST_F(EepromI2c, commits_the_oldest_page_when_out_of_buffers) {
+    for (uint16_t i = 0; i < EXTERNAL_EEPROM_WRITE_BUFFER_PAGES; i++) {
+        write(i * EXTERNAL_EEPROM_PAGE_SIZE, {(uint8_t)i});
+        advance_time(1);
+    }
+    EXPECT_TRUE(page_writes.empty());
+
+    write(EXTERNAL_EEPROM_WRITE_BUFFER_PAGES * EXTERNAL_EEPROM_PAGE_SIZE, {0x42});
+    ASSERT_EQ(page_writes.size(), 1);
+    EXPECT_EQ(page_writes[0].address, 0);
+}
+
+TEST_F(EepromI2c, polls_instead_of_waiting) {
+    eeprom_driver_erase();
+
+    uint16_t pages = EXTERNAL_EEPROM_BYTE_COUNT / EXTERNAL_EEPROM_PAGE_SIZE;
+    EXPECT_EQ(page_writes.size(), pages);
+    EXPECT_LE(timer_read32(), pages * (device_write_time + 1));
+    EXPECT_LT(device_write_time, EXTERNAL_EEPROM_WRITE_TIME);
+    for (auto value : memory) {
+        EXPECT_EQ(value, 0);
+    }
+}
+
+TEST_F(EepromI2c, flush_writes_everything_out) {
+    write(0, {1});
+    write(EXTERNAL_EEPROM_PAGE_SIZE, {2});
+    eeprom_driver_flush();
+
+    EXPECT_EQ(page_writes.size(), 2);
+    EXPECT_EQ(memory[0], 1);
+    EXPECT_EQ(memory[EXTERNAL_EEPROM_PAGE_SIZE], 2);
+    EXPECT_GE(timer_read32(), busy_until);
+}
+
+TEST_F(EepromI2c, matches_random_writes) {
+    std::vector<uint8_t> expected(memory);
+    srand(1);
+    for (int i = 0; i < 2000; i++) {
+        uint16_t             address = rand() % (EXTERNAL_EEPROM_BYTE_COUNT / 8);
+        uint16_t             length  = 1 + rand() % 40;
+        std::vector<uint8_t> data(length);
+        if (address + length > EXTERNAL_EEPROM_BYTE_COUNT) {
+            continue;
+        }
+        for (auto& value : data) {
+            value = rand();
+        }
+        write(address, data);
+        std::copy(data.begin(), data.end(), expected.begin() + address);
+
+        run(rand() % 4);
+        uint16_t check = rand() % (EXTERNAL_EEPROM_BYTE_COUNT / 8);
+        EXPECT_EQ(read(check, 64), std::vector<uint8_t>(expected.begin() + check, expected.begin() + check + 64));
+    }
+
+    eeprom_driver_flush();
+    EXPECT_EQ(memory, expected);
+}
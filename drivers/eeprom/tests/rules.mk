@@ -0,0 +1,11 @@
+eeprom_i2c_SRC :=\
+	$(DRIVER_PATH)/eeprom/tests/eeprom_i2c_tests.cpp \
+	$(DRIVER_PATH)/eeprom/eeprom_i2c.c \
+	$(DRIVER_PATH)/eeprom/eeprom_driver.c \
+	$(TMK_PATH)/common/test/timer.c
+
+eeprom_i2c_INC :=\
+	$(TOP_DIR)/tests/test_common \
+	$(DRIVER_PATH)/eeprom
+
+eeprom_i2c_DEFS := -DEEPROM_DRIVER
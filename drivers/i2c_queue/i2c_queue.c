@@ -0,0 +1,112 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stddef.h>
+#include "i2c_queue.h"
+#include "wait.h"
+
+// The queue itself is only touched from the main loop; the backend only ever
+// writes the status and state of the active job.
+static i2c_job_t *         queue_head;
+static i2c_job_t *         queue_tail;
+static i2c_job_t *volatile active_job;
+
+static void start_next_job(void) {
+    if (active_job || !queue_head) {
+        return;
+    }
+
+    i2c_job_t *job = queue_head;
+    queue_head     = job->next;
+    if (!queue_head) {
+        queue_tail = NULL;
+    }
+    job->next  = NULL;
+    job->state = I2C_JOB_ACTIVE;
+    active_job = job;
+    i2c_queue_bus_start(job);
+}
+
+/*
+ * Appends job to the queue and starts it right away if the bus is free.
+ * Returns false if the job is still queued or in flight.
+ */
+bool i2c_queue_submit(i2c_job_t *job) {
+    if (i2c_queue_is_busy(job)) {
+        return false;
+    }
+
+    job->next   = NULL;
+    job->status = I2C_STATUS_SUCCESS;
+    job->state  = I2C_JOB_QUEUED;
+    if (queue_tail) {
+        queue_tail->next = job;
+    } else {
+        queue_head = job;
+    }
+    queue_tail = job;
+
+    start_next_job();
+    return true;
+}
+
+void i2c_queue_bus_complete(i2c_status_t status) {
+    i2c_job_t *job = active_job;
+    if (job) {
+        job->status = status;
+        job->state  = I2C_JOB_FINISHED;
+    }
+}
+
+/*
+ * Retires the finished job, keeps the bus busy with the next one and then runs
+ * the callback, which is free to resubmit the job it was handed.
+ */
+void i2c_queue_task(void) {
+    i2c_job_t *job = active_job;
+    if (!job || job->state != I2C_JOB_FINISHED) {
+        return;
+    }
+
+    active_job = NULL;
+    job->state = I2C_JOB_IDLE;
+    start_next_job();
+
+    if (job->callback) {
+        job->callback(job);
+    }
+}
+
+bool i2c_queue_is_busy(const i2c_job_t *job) { return job->state != I2C_JOB_IDLE; }
+
+bool i2c_queue_is_idle(void) { return !active_job && !queue_head; }
+
+i2c_status_t i2c_queue_wait(i2c_job_t *job) {
+    while (i2c_queue_is_busy(job)) {
+        i2c_queue_task();
+    }
+    return job->status;
+}
+
+/*
+ * Waits for the transfer in flight, so the synchronous i2c_master functions
+ * can use the bus in between two queued jobs. The backend enforces the job's
+ * timeout, this sleeps in between checks so a backend thread gets to run.
+ */
+void i2c_queue_wait_idle(void) {
+    while (active_job && active_job->state == I2C_JOB_ACTIVE) {
+        wait_ms(1);
+    }
+}
@@ -0,0 +1,92 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "i2c_master.h"
+
+/*
+ * Asynchronous I2C transaction queue.
+ *
+ * Callers describe a transaction with a statically allocated i2c_job_t and
+ * submit it; the job is started as soon as the bus is free and the main loop
+ * keeps scanning while it runs. i2c_queue_task() is called from
+ * keyboard_task() and runs the callback of every job that has finished.
+ *
+ * The transmitted data is described as a list of segments that are sent back
+ * to back in a single transfer, so a register write can point at the register
+ * address and the payload separately instead of copying them into one packet.
+ * The job, its segments and all the buffers they point to must stay valid
+ * until the job has completed.
+ *
+ * Addresses are expected to be already shifted (addr << 1), like the rest of
+ * the i2c_master API.
+ */
+
+// Largest job with more than one segment that the ChibiOS backend can gather
+// into a single DMA transfer
+#ifndef I2C_QUEUE_BUFFER_SIZE
+#    define I2C_QUEUE_BUFFER_SIZE 256
+#endif
+
+typedef struct {
+    const uint8_t *data;
+    uint16_t       length;
+} i2c_segment_t;
+
+typedef enum {
+    I2C_JOB_IDLE = 0,
+    I2C_JOB_QUEUED,
+    I2C_JOB_ACTIVE,
+    I2C_JOB_FINISHED,
+} i2c_job_state_t;
+
+typedef struct i2c_job_t i2c_job_t;
+
+struct i2c_job_t {
+    uint8_t              address;
+    const i2c_segment_t *segments;
+    uint8_t              num_segments;
+    uint8_t *            rx_data;  // read after a repeated start, once all segments are written
+    uint16_t             rx_length;
+    uint16_t             timeout;
+    void (*callback)(i2c_job_t *job);
+
+    // Managed by the queue
+    i2c_job_t *              next;
+    volatile i2c_job_state_t state;
+    volatile i2c_status_t    status;
+};
+
+bool         i2c_queue_submit(i2c_job_t *job);
+void         i2c_queue_task(void);
+bool         i2c_queue_is_busy(const i2c_job_t *job);
+bool         i2c_queue_is_idle(void);
+i2c_status_t i2c_queue_wait(i2c_job_t *job);
+void         i2c_queue_wait_idle(void);
+
+/*
+ * Platform backend.
+ *
+ * i2c_queue_bus_start() is called with one job at a time and must not block
+ * for the duration of the transfer; the backend reports the result through
+ * i2c_queue_bus_complete(), which may be called from a driver thread or an
+ * interrupt, or directly from i2c_queue_bus_start() on platforms that can only
+ * transfer synchronously. Timeouts are enforced by the backend.
+ */
+void i2c_queue_bus_start(i2c_job_t *job);
+void i2c_queue_bus_complete(i2c_status_t status);
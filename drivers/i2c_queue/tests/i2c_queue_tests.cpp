@@ -0,0 +1,288 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include <vector>
+extern "C" {
+#include "i2c_queue.h"
+#include "timer.h"
+
+void set_time(uint32_t t);
+}
+
+struct transfer_t {
+    uint8_t              address;
+    std::vector<uint8_t> data;
+};
+
+// Mock bus: records every transfer that is started and lets the test decide
+// when, and how, it completes
+static std::vector<transfer_t> transfers;
+static i2c_job_t*              bus_job;
+static bool                    bus_synchronous;
+static i2c_status_t            bus_result;
+static uint8_t                 bus_rx_value;
+
+void i2c_queue_bus_start(i2c_job_t* job) {
+    EXPECT_EQ(bus_job, nullptr);
+    bus_job = job;
+
+    transfer_t transfer = {job->address, {}};
+    for (uint8_t i = 0; i < job->num_segments; i++) {
+        transfer.data.insert(transfer.data.end(), job->segments[i].data, job->segments[i].data + job->segments[i].length);
+    }
+    transfers.push_back(transfer);
+
+    if (bus_synchronous) {
+        bus_job = nullptr;
+        i2c_queue_bus_complete(bus_result);
+    }
+}
+
+static void bus_finish(i2c_status_t status) {
+    ASSERT_NE(bus_job, nullptr);
+    for (uint16_t i = 0; i < bus_job->rx_length; i++) {
+        bus_job->rx_data[i] = bus_rx_value + i;
+    }
+    bus_job = nullptr;
+    i2c_queue_bus_complete(status);
+}
+
+static std::vector<i2c_job_t*> completed;
+
+static void record_completion(i2c_job_t* job) { completed.push_back(job); }
+
+class I2cQueue : public testing::Test {
+   public:
+    I2cQueue() {
+        transfers.clear();
+        completed.clear();
+        bus_job         = nullptr;
+        bus_synchronous = false;
+        bus_result      = I2C_STATUS_SUCCESS;
+        bus_rx_value    = 0;
+        set_time(0);
+    }
+
+    ~I2cQueue() {
+        // Leave the queue empty for the next test
+        while (bus_job) {
+            bus_finish(I2C_STATUS_SUCCESS);
+            i2c_queue_task();
+        }
+        i2c_queue_task();
+        EXPECT_TRUE(i2c_queue_is_idle());
+    }
+
+    // Jobs live in the fixture, so they outlive a test that leaves them queued
+    i2c_job_t jobs[3];
+
+    static void init_job(i2c_job_t* job, uint8_t address, const i2c_segment_t* segments, uint8_t num_segments) {
+        *job              = {};
+        job->address      = address;
+        job->segments     = segments;
+        job->num_segments = num_segments;
+        job->timeout      = 100;
+        job->callback     = record_completion;
+    }
+};
+
+TEST_F(I2cQueue, starts_a_job_when_the_bus_is_idle) {
+    static const uint8_t       data[]     = {1, 2, 3};
+    static const i2c_segment_t segments[] = {{data, sizeof(data)}};
+    i2c_job_t&                 job        = jobs[0];
+    init_job(&job, 0x3C << 1, segments, 1);
+
+    EXPECT_TRUE(i2c_queue_submit(&job));
+    ASSERT_EQ(transfers.size(), 1u);
+    EXPECT_EQ(transfers[0].address, 0x3C << 1);
+    EXPECT_EQ(transfers[0].data, std::vector<uint8_t>({1, 2, 3}));
+    EXPECT_TRUE(i2c_queue_is_busy(&job));
+}
+
+TEST_F(I2cQueue, writes_segments_back_to_back) {
+    static const uint8_t       reg        = 0x40;
+    static const uint8_t       payload[]  = {0xAA, 0xBB};
+    static const i2c_segment_t segments[] = {{&reg, 1}, {payload, sizeof(payload)}};
+    i2c_job_t&                 job        = jobs[0];
+    init_job(&job, 0x20, segments, 2);
+
+    i2c_queue_submit(&job);
+    ASSERT_EQ(transfers.size(), 1u);
+    EXPECT_EQ(transfers[0].data, std::vector<uint8_t>({0x40, 0xAA, 0xBB}));
+}
+
+TEST_F(I2cQueue, runs_jobs_in_submission_order) {
+    static const uint8_t       data[3]    = {10, 20, 30};
+    static const i2c_segment_t segments[] = {{&data[0], 1}, {&data[1], 1}, {&data[2], 1}};
+    for (uint8_t i = 0; i < 3; i++) {
+        init_job(&jobs[i], 0x10 + i, &segments[i], 1);
+        EXPECT_TRUE(i2c_queue_submit(&jobs[i]));
+    }
+
+    // Only one transfer is on the bus at a time
+    EXPECT_EQ(transfers.size(), 1u);
+    for (uint8_t i = 0; i < 3; i++) {
+        bus_finish(I2C_STATUS_SUCCESS);
+        i2c_queue_task();
+    }
+
+    ASSERT_EQ(transfers.size(), 3u);
+    ASSERT_EQ(completed.size(), 3u);
+    for (uint8_t i = 0; i < 3; i++) {
+        EXPECT_EQ(transfers[i].address, 0x10 + i);
+        EXPECT_EQ(transfers[i].data[0], data[i]);
+        EXPECT_EQ(completed[i], &jobs[i]);
+        EXPECT_FALSE(i2c_queue_is_busy(&jobs[i]));
+    }
+}
+
+TEST_F(I2cQueue, callbacks_run_from_the_task) {
+    static const uint8_t       data       = 0;
+    static const i2c_segment_t segments[] = {{&data, 1}};
+    i2c_job_t&                 job        = jobs[0];
+    init_job(&job, 0x20, segments, 1);
+
+    i2c_queue_submit(&job);
+    bus_finish(I2C_STATUS_SUCCESS);
+    EXPECT_TRUE(completed.empty());
+    EXPECT_TRUE(i2c_queue_is_busy(&job));
+
+    i2c_queue_task();
+    ASSERT_EQ(completed.size(), 1u);
+    EXPECT_EQ(job.status, I2C_STATUS_SUCCESS);
+}
+
+TEST_F(I2cQueue, rejects_jobs_that_are_in_flight) {
+    static const uint8_t       data       = 0;
+    static const i2c_segment_t segments[] = {{&data, 1}};
+    i2c_job_t&                 first      = jobs[0];
+    i2c_job_t&                 second     = jobs[1];
+    init_job(&first, 0x20, segments, 1);
+    init_job(&second, 0x22, segments, 1);
+
+    EXPECT_TRUE(i2c_queue_submit(&first));
+    EXPECT_TRUE(i2c_queue_submit(&second));
+    EXPECT_FALSE(i2c_queue_submit(&first));
+    EXPECT_FALSE(i2c_queue_submit(&second));
+
+    bus_finish(I2C_STATUS_SUCCESS);
+    i2c_queue_task();
+    EXPECT_TRUE(i2c_queue_submit(&first));
+}
+
+TEST_F(I2cQueue, timeouts_are_reported_and_the_queue_moves_on) {
+    static const uint8_t       data       = 0;
+    static const i2c_segment_t segments[] = {{&data, 1}};
+    i2c_job_t&                 stuck      = jobs[0];
+    i2c_job_t&                 next       = jobs[1];
+    init_job(&stuck, 0x20, segments, 1);
+    init_job(&next, 0x22, segments, 1);
+
+    i2c_queue_submit(&stuck);
+    i2c_queue_submit(&next);
+    bus_finish(I2C_STATUS_TIMEOUT);
+    i2c_queue_task();
+
+    EXPECT_EQ(stuck.status, I2C_STATUS_TIMEOUT);
+    ASSERT_EQ(transfers.size(), 2u);
+    EXPECT_EQ(transfers[1].address, 0x22);
+
+    bus_finish(I2C_STATUS_ERROR);
+    i2c_queue_task();
+    EXPECT_EQ(next.status, I2C_STATUS_ERROR);
+    EXPECT_EQ(completed.size(), 2u);
+}
+
+TEST_F(I2cQueue, reads_after_writing) {
+    static const uint8_t       reg        = 0x0F;
+    static const i2c_segment_t segments[] = {{&reg, 1}};
+    uint8_t                    rx[4]      = {};
+    i2c_job_t&                 job        = jobs[0];
+    init_job(&job, 0x30, segments, 1);
+    job.rx_data   = rx;
+    job.rx_length = sizeof(rx);
+
+    bus_rx_value = 0x80;
+    i2c_queue_submit(&job);
+    bus_finish(I2C_STATUS_SUCCESS);
+    EXPECT_EQ(i2c_queue_wait(&job), I2C_STATUS_SUCCESS);
+    EXPECT_EQ(rx[0], 0x80);
+    EXPECT_EQ(rx[3], 0x83);
+}
+
+static i2c_job_t resubmitted_job;
+static uint8_t   resubmit_count;
+
+static void resubmit(i2c_job_t* job) {
+    if (++resubmit_count < 3) {
+        EXPECT_TRUE(i2c_queue_submit(job));
+    }
+}
+
+TEST_F(I2cQueue, callbacks_can_resubmit_their_job) {
+    static const uint8_t       data       = 0;
+    static const i2c_segment_t segments[] = {{&data, 1}};
+    init_job(&resubmitted_job, 0x20, segments, 1);
+    resubmitted_job.callback = resubmit;
+    resubmit_count           = 0;
+
+    i2c_queue_submit(&resubmitted_job);
+    for (uint8_t i = 0; i < 3; i++) {
+        bus_finish(I2C_STATUS_SUCCESS);
+        i2c_queue_task();
+    }
+    EXPECT_EQ(resubmit_count, 3);
+    EXPECT_EQ(transfers.size(), 3u);
+    EXPECT_TRUE(i2c_queue_is_idle());
+}
+
+TEST_F(I2cQueue, works_with_synchronous_backends) {
+    static const uint8_t       data       = 0;
+    static const i2c_segment_t segments[] = {{&data, 1}};
+    i2c_job_t&                 first      = jobs[0];
+    i2c_job_t&                 second     = jobs[1];
+    init_job(&first, 0x20, segments, 1);
+    init_job(&second, 0x22, segments, 1);
+
+    bus_synchronous = true;
+    bus_result      = I2C_STATUS_TIMEOUT;
+    i2c_queue_submit(&first);
+    i2c_queue_submit(&second);
+    EXPECT_EQ(transfers.size(), 1u);
+
+    EXPECT_EQ(i2c_queue_wait(&second), I2C_STATUS_TIMEOUT);
+    EXPECT_EQ(first.status, I2C_STATUS_TIMEOUT);
+    EXPECT_EQ(transfers.size(), 2u);
+    EXPECT_EQ(completed.size(), 2u);
+}
+
+TEST_F(I2cQueue, waiting_for_the_bus_returns_once_the_transfer_is_done) {
+    static const uint8_t       data       = 0;
+    static const i2c_segment_t segments[] = {{&data, 1}};
+    i2c_job_t&                 job        = jobs[0];
+    init_job(&job, 0x20, segments, 1);
+
+    i2c_queue_wait_idle();
+    EXPECT_EQ(timer_read32(), 0u);
+
+    // Finished, but not retired by the task yet
+    i2c_queue_submit(&job);
+    bus_finish(I2C_STATUS_TIMEOUT);
+    i2c_queue_wait_idle();
+    EXPECT_EQ(timer_read32(), 0u);
+    EXPECT_TRUE(i2c_queue_is_busy(&job));
+}
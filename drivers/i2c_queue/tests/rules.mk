@@ -0,0 +1,8 @@
+i2c_queue_SRC :=\
+	$(DRIVER_PATH)/i2c_queue/tests/i2c_queue_tests.cpp \
+	$(DRIVER_PATH)/i2c_queue/i2c_queue.c \
+	$(TMK_PATH)/common/test/timer.c
+
+i2c_queue_INC :=\
+	$(TOP_DIR)/tests/test_common \
+	$(DRIVER_PATH)/i2c_queue
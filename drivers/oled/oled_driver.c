@@ -15,6 +15,9 @@ You should have received a copy of the GNU General Public License
 along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 #include "i2c_master.h"
+#ifdef I2C_QUEUE_ENABLE
+#    include "i2c_queue.h"
+#endif
 #include "oled_driver.h"
 #include OLED_FONT_H
 #include "timer.h"
@@ -77,6 +80,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 // Misc defines
 #define OLED_BLOCK_COUNT (sizeof(OLED_BLOCK_TYPE) * 8)
 #define OLED_BLOCK_SIZE (OLED_MATRIX_SIZE / OLED_BLOCK_COUNT)
+#define OLED_PAGE_COUNT (OLED_DISPLAY_HEIGHT / 8)
 
 // i2c defines
 #define I2C_CMD 0x00
@@ -96,9 +100,11 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 // Display buffer's is the same as the OLED memory layout
 // this is so we don't end up with rounding errors with
 // parts of the display unusable or don't get cleared correctly
-// and also allows for drawing & inverting
+// and also allows for drawing & inverting.
+// This is also true when rotated by 90 degrees: drawing transposes the data
+// as it is written, so rendering never has to.
 uint8_t         oled_buffer[OLED_MATRIX_SIZE];
-uint8_t *       oled_cursor;
+uint16_t        oled_cursor;  // index of a byte in the rotated layout, see read_byte()
 OLED_BLOCK_TYPE oled_dirty          = 0;
 bool            oled_initialized    = false;
 bool            oled_active         = false;
@@ -114,6 +120,13 @@ uint32_t oled_timeout;
 #if OLED_SCROLL_TIMEOUT > 0
 uint32_t oled_scroll_timeout;
 #endif
+#ifdef OLED_SHADOW_ENABLE
+// What the panel is currently showing, so only the bytes that differ from it
+// are sent. Columns from oled_valid_columns onwards in a page are unknown,
+// e.g. after init or scrolling, and always sent.
+static uint8_t oled_shadow[OLED_MATRIX_SIZE];
+static uint8_t oled_valid_columns[OLED_PAGE_COUNT];
+#endif
 
 // Internal variables to reduce math instructions
 
@@ -134,16 +147,64 @@ static i2c_status_t i2c_transmit_P(uint8_t address, const uint8_t *data, uint16_
 }
 #endif
 
-// Flips the rendering bits for a character at the current cursor position
-static void InvertCharacter(uint8_t *cursor) {
-    const uint8_t *end = cursor + OLED_FONT_WIDTH;
-    while (cursor < end) {
-        *cursor = ~(*cursor);
-        cursor++;
+#ifdef OLED_SHADOW_ENABLE
+// Forces the given pages to be sent in full on the next render
+static void invalidate_pages(uint8_t pages) {
+    for (uint8_t page = 0; page < OLED_PAGE_COUNT; page++) {
+        if (pages & (1 << page)) {
+            oled_valid_columns[page] = 0;
+        }
+    }
+    oled_dirty = -1;
+}
+#endif
+
+static inline void mark_dirty(uint16_t index) { oled_dirty |= ((OLED_BLOCK_TYPE)1 << (index / OLED_BLOCK_SIZE)); }
+
+// Drawing addresses bytes of 8 vertical pixels in the rotated layout, where
+// each line is oled_rotation_width bytes long. With 90 degree rotation, a
+// byte in the rotated layout is a row of 8 pixels on the panel: one bit in
+// each of 8 consecutive columns of the native buffer.
+static uint8_t read_byte(uint16_t index) {
+    if (!HAS_FLAGS(oled_rotation, OLED_ROTATION_90)) {
+        return oled_buffer[index];
+    }
+
+    uint8_t        y      = OLED_DISPLAY_HEIGHT - 1 - index % OLED_DISPLAY_HEIGHT;
+    const uint8_t *column = &oled_buffer[y / 8 * OLED_DISPLAY_WIDTH + index / OLED_DISPLAY_HEIGHT * 8];
+    uint8_t        data   = 0;
+    for (uint8_t i = 0; i < 8; ++i) {
+        data |= ((column[i] >> (y % 8)) & 1) << i;
     }
+    return data;
 }
 
-bool oled_init(uint8_t rotation) {
+static void write_byte(uint16_t index, uint8_t data) {
+    if (read_byte(index) == data) {
+        return;
+    }
+
+    if (!HAS_FLAGS(oled_rotation, OLED_ROTATION_90)) {
+        oled_buffer[index] = data;
+        mark_dirty(index);
+        return;
+    }
+
+    uint8_t  y     = OLED_DISPLAY_HEIGHT - 1 - index % OLED_DISPLAY_HEIGHT;
+    uint16_t start = y / 8 * OLED_DISPLAY_WIDTH + index / OLED_DISPLAY_HEIGHT * 8;
+    uint8_t  mask  = 1 << (y % 8);
+    for (uint8_t i = 0; i < 8; ++i) {
+        if (data & (1 << i)) {
+            oled_buffer[start + i] |= mask;
+        } else {
+            oled_buffer[start + i] &= ~mask;
+        }
+    }
+    mark_dirty(start);
+    mark_dirty(start + 7);
+}
+
+bool oled_init(oled_rotation_t rotation) {
     oled_rotation = oled_init_user(rotation);
     if (!HAS_FLAGS(oled_rotation, OLED_ROTATION_90)) {
         oled_rotation_width = OLED_DISPLAY_WIDTH;
@@ -203,6 +264,9 @@ bool oled_init(uint8_t rotation) {
 #endif
 
     oled_clear();
+#ifdef OLED_SHADOW_ENABLE
+    invalidate_pages(0xFF);
+#endif
     oled_initialized = true;
     oled_active      = true;
     oled_scrolling   = false;
@@ -213,10 +277,11 @@ __attribute__((weak)) oled_rotation_t oled_init_user(oled_rotation_t rotation) {
 
 void oled_clear(void) {
     memset(oled_buffer, 0, sizeof(oled_buffer));
-    oled_cursor = &oled_buffer[0];
+    oled_cursor = 0;
     oled_dirty  = -1;  // -1 will be max value as long as display_dirty is unsigned type
 }
 
+#ifndef OLED_SHADOW_ENABLE
 static void calc_bounds(uint8_t update_start, uint8_t *cmd_array) {
     // Calculate commands to set memory addressing bounds.
     uint8_t start_page   = OLED_BLOCK_SIZE * update_start / OLED_DISPLAY_WIDTH;
@@ -239,84 +304,233 @@ static void calc_bounds(uint8_t update_start, uint8_t *cmd_array) {
 #endif
 }
 
-static void calc_bounds_90(uint8_t update_start, uint8_t *cmd_array) {
-    cmd_array[1] = OLED_BLOCK_SIZE * update_start / OLED_DISPLAY_HEIGHT * 8;
-    cmd_array[4] = OLED_BLOCK_SIZE * update_start % OLED_DISPLAY_HEIGHT;
-    cmd_array[2] = (OLED_BLOCK_SIZE + OLED_DISPLAY_HEIGHT - 1) / OLED_DISPLAY_HEIGHT * 8 - 1 + cmd_array[1];
-    ;
-    cmd_array[5] = (OLED_BLOCK_SIZE + OLED_DISPLAY_HEIGHT - 1) % OLED_DISPLAY_HEIGHT / 8;
+static void render_blocks(void) {
+    // Find first dirty block
+    uint8_t update_start = 0;
+    while (!(oled_dirty & ((OLED_BLOCK_TYPE)1 << update_start))) {
+        ++update_start;
+    }
+
+    // Set column & page position
+    static uint8_t display_start[] = {I2C_CMD, COLUMN_ADDR, 0, OLED_DISPLAY_WIDTH - 1, PAGE_ADDR, 0, OLED_DISPLAY_HEIGHT / 8 - 1};
+    calc_bounds(update_start, &display_start[1]);  // Offset from I2C_CMD byte at the start
+
+    // Send column & page position
+    if (I2C_TRANSMIT(display_start) != I2C_STATUS_SUCCESS) {
+        print("oled_render offset command failed\n");
+        return;
+    }
+
+    // Send render data chunk as is
+    if (I2C_WRITE_REG(I2C_DATA, &oled_buffer[OLED_BLOCK_SIZE * update_start], OLED_BLOCK_SIZE) != I2C_STATUS_SUCCESS) {
+        print("oled_render data failed\n");
+        return;
+    }
+
+    // Turn on display if it is off
+    oled_on();
+
+    // Clear dirty flag
+    oled_dirty &= ~((OLED_BLOCK_TYPE)1 << update_start);
+}
+#else
+static uint8_t oled_render_cmd[7];
+#    ifdef I2C_QUEUE_ENABLE
+static void render_complete(i2c_job_t *job);
+
+static const uint8_t oled_data_mode = I2C_DATA;
+static uint8_t       oled_render_pages;
+static i2c_segment_t oled_render_segments[] = {{oled_render_cmd, 0}, {&oled_data_mode, 1}, {NULL, 0}};
+static i2c_job_t     oled_cmd_job           = {.address = (OLED_DISPLAY_ADDRESS << 1), .segments = &oled_render_segments[0], .num_segments = 1, .timeout = I2C_TIMEOUT, .callback = render_complete};
+static i2c_job_t     oled_data_job          = {.address = (OLED_DISPLAY_ADDRESS << 1), .segments = &oled_render_segments[1], .num_segments = 2, .timeout = I2C_TIMEOUT, .callback = render_complete};
+
+static void render_complete(i2c_job_t *job) {
+    if (job->status != I2C_STATUS_SUCCESS) {
+        print("oled_render transfer failed\n");
+        invalidate_pages(oled_render_pages);
+    }
 }
+#    endif
 
-uint8_t crot(uint8_t a, int8_t n) {
-    const uint8_t mask = 0x7;
-    n &= mask;
-    return a << n | a >> (-n & mask);
+static bool render_ready(void) {
+#    ifdef I2C_QUEUE_ENABLE
+    return !i2c_queue_is_busy(&oled_cmd_job) && !i2c_queue_is_busy(&oled_data_job);
+#    else
+    return true;
+#    endif
 }
 
-static void rotate_90(const uint8_t *src, uint8_t *dest) {
-    for (uint8_t i = 0, shift = 7; i < 8; ++i, --shift) {
-        uint8_t selector = (1 << i);
-        for (uint8_t j = 0; j < 8; ++j) {
-            dest[i] |= crot(src[j] & selector, shift - (int8_t)j);
+static uint8_t block_pages(uint8_t block) {
+    uint8_t first = OLED_BLOCK_SIZE * block / OLED_DISPLAY_WIDTH;
+    uint8_t last  = (OLED_BLOCK_SIZE * (block + 1) - 1) / OLED_DISPLAY_WIDTH;
+    return (1 << (last + 1)) - (1 << first);
+}
+
+static inline bool column_changed(uint8_t page, uint8_t column) {
+    uint16_t index = page * OLED_DISPLAY_WIDTH + column;
+    return column >= oled_valid_columns[page] || oled_buffer[index] != oled_shadow[index];
+}
+
+// Finds the next run of changed columns in a page, starting at column. Runs
+// separated by only a few unchanged columns are merged, as addressing a new
+// rectangle costs more than sending the bytes in between.
+static bool find_run(uint8_t page, uint8_t column, uint8_t *start, uint8_t *end) {
+    while (column < OLED_DISPLAY_WIDTH && !column_changed(page, column)) {
+        ++column;
+    }
+    if (column >= OLED_DISPLAY_WIDTH) {
+        return false;
+    }
+
+    *start = *end = column;
+    for (uint8_t gap = 0; ++column < OLED_DISPLAY_WIDTH;) {
+        if (column_changed(page, column)) {
+            *end = column;
+            gap  = 0;
+        } else if (++gap > OLED_RENDER_MERGE_GAP) {
+            break;
         }
     }
+    return true;
 }
 
-void oled_render(void) {
-    // Do we have work to do?
-    if (!oled_dirty || oled_scrolling) {
-        return;
+// Sends a rectangle, which must be contiguous in the buffer: either a single
+// page, or full width pages.
+static bool render_rect(uint8_t page_start, uint8_t page_end, uint8_t column_start, uint8_t column_end) {
+    uint16_t start  = page_start * OLED_DISPLAY_WIDTH + column_start;
+    uint16_t length = (page_end - page_start + 1) * (column_end - column_start + 1);
+    memcpy(&oled_shadow[start], &oled_buffer[start], length);
+
+    for (uint8_t page = page_start; page <= page_end; page++) {
+        if (column_start <= oled_valid_columns[page] && column_end >= oled_valid_columns[page]) {
+            oled_valid_columns[page] = column_end + 1;
+        }
     }
 
-    // Find first dirty block
-    uint8_t update_start = 0;
-    while (!(oled_dirty & (1 << update_start))) {
-        ++update_start;
+#    if (OLED_IC == OLED_IC_SH1106)
+    // Page Addressing Mode only has a start position
+    uint8_t cmd_length = 4;
+    oled_render_cmd[0] = I2C_CMD;
+    oled_render_cmd[1] = PAM_PAGE_ADDR | page_start;
+    oled_render_cmd[2] = PAM_SETCOLUMN_LSB | ((OLED_COLUMN_OFFSET + column_start) & 0x0f);
+    oled_render_cmd[3] = PAM_SETCOLUMN_MSB | ((OLED_COLUMN_OFFSET + column_start) >> 4 & 0x0f);
+#    else
+    uint8_t cmd_length = 7;
+    oled_render_cmd[0] = I2C_CMD;
+    oled_render_cmd[1] = COLUMN_ADDR;
+    oled_render_cmd[2] = column_start;
+    oled_render_cmd[3] = column_end;
+    oled_render_cmd[4] = PAGE_ADDR;
+    oled_render_cmd[5] = page_start;
+    oled_render_cmd[6] = page_end;
+#    endif
+
+#    ifdef I2C_QUEUE_ENABLE
+    // Sent straight from the shadow, which is left alone until the jobs are done
+    oled_render_pages              = (1 << (page_end + 1)) - (1 << page_start);
+    oled_render_segments[0].length = cmd_length;
+    oled_render_segments[2].data   = &oled_shadow[start];
+    oled_render_segments[2].length = length;
+    i2c_queue_submit(&oled_cmd_job);
+    i2c_queue_submit(&oled_data_job);
+#    else
+    if (i2c_transmit((OLED_DISPLAY_ADDRESS << 1), oled_render_cmd, cmd_length, I2C_TIMEOUT) != I2C_STATUS_SUCCESS) {
+        print("oled_render offset command failed\n");
+        invalidate_pages((1 << (page_end + 1)) - (1 << page_start));
+        return false;
     }
 
-    // Set column & page position
-    static uint8_t display_start[] = {I2C_CMD, COLUMN_ADDR, 0, OLED_DISPLAY_WIDTH - 1, PAGE_ADDR, 0, OLED_DISPLAY_HEIGHT / 8 - 1};
-    if (!HAS_FLAGS(oled_rotation, OLED_ROTATION_90)) {
-        calc_bounds(update_start, &display_start[1]);  // Offset from I2C_CMD byte at the start
-    } else {
-        calc_bounds_90(update_start, &display_start[1]);  // Offset from I2C_CMD byte at the start
+    if (I2C_WRITE_REG(I2C_DATA, &oled_shadow[start], length) != I2C_STATUS_SUCCESS) {
+        print("oled_render data failed\n");
+        invalidate_pages((1 << (page_end + 1)) - (1 << page_start));
+        return false;
     }
+#    endif
+    return true;
+}
 
-    // Send column & page position
-    if (I2C_TRANSMIT(display_start) != I2C_STATUS_SUCCESS) {
-        print("oled_render offset command failed\n");
-        return;
+// Sends what changed in the dirty blocks, as a few rectangles as possible,
+// up to OLED_RENDER_LIMIT bytes per call.
+static void render_changes(void) {
+    uint8_t dirty_pages = 0;
+    for (uint8_t block = 0; block < OLED_BLOCK_COUNT; block++) {
+        if (oled_dirty & ((OLED_BLOCK_TYPE)1 << block)) {
+            dirty_pages |= block_pages(block);
+        }
     }
 
-    if (!HAS_FLAGS(oled_rotation, OLED_ROTATION_90)) {
-        // Send render data chunk as is
-        if (I2C_WRITE_REG(I2C_DATA, &oled_buffer[OLED_BLOCK_SIZE * update_start], OLED_BLOCK_SIZE) != I2C_STATUS_SUCCESS) {
-            print("oled_render data failed\n");
-            return;
+    uint8_t  clean_pages = 0;
+    uint16_t budget      = OLED_RENDER_LIMIT;
+    bool     rendered    = false;
+    for (uint8_t page = 0; page < OLED_PAGE_COUNT; page++) {
+        if (!(dirty_pages & (1 << page))) {
+            continue;
         }
-    } else {
-        // Rotate the render chunks
-        const static uint8_t source_map[] = OLED_SOURCE_MAP;
-        const static uint8_t target_map[] = OLED_TARGET_MAP;
-
-        static uint8_t temp_buffer[OLED_BLOCK_SIZE];
-        memset(temp_buffer, 0, sizeof(temp_buffer));
-        for (uint8_t i = 0; i < sizeof(source_map); ++i) {
-            rotate_90(&oled_buffer[OLED_BLOCK_SIZE * update_start + source_map[i]], &temp_buffer[target_map[i]]);
+
+        uint8_t start, end;
+        uint8_t column   = 0;
+        uint8_t page_end = page;
+        while (find_run(page, column, &start, &end)) {
+            if (!budget || !render_ready()) {
+                goto finish;
+            }
+
+#    if (OLED_IC != OLED_IC_SH1106)
+            // Full width pages are contiguous, so following pages that changed
+            // across their full width too go out as one rectangle
+            if (start == 0 && end == OLED_DISPLAY_WIDTH - 1) {
+                uint8_t next_start, next_end;
+                while (page_end + 1 < OLED_PAGE_COUNT && (dirty_pages & (1 << (page_end + 1))) && (page_end - page + 2) * OLED_DISPLAY_WIDTH <= budget && find_run(page_end + 1, 0, &next_start, &next_end) && next_start == 0 && next_end == OLED_DISPLAY_WIDTH - 1) {
+                    ++page_end;
+                }
+            }
+#    endif
+            if (end - start + 1 > budget) {
+                end = start + budget - 1;
+            }
+
+            if (!render_rect(page, page_end, start, end)) {
+                goto finish;
+            }
+            rendered = true;
+            budget -= (page_end - page + 1) * (end - start + 1);
+            if (end == OLED_DISPLAY_WIDTH - 1) {
+                break;
+            }
+            column = end + 1;
         }
 
-        // Send render data chunk after rotating
-        if (I2C_WRITE_REG(I2C_DATA, &temp_buffer[0], OLED_BLOCK_SIZE) != I2C_STATUS_SUCCESS) {
-            print("oled_render90 data failed\n");
-            return;
+        clean_pages |= (1 << (page_end + 1)) - (1 << page);
+        page = page_end;
+    }
+
+finish:
+    // Blocks are clean once all of the pages they cover are
+    dirty_pages &= ~clean_pages;
+    for (uint8_t block = 0; block < OLED_BLOCK_COUNT; block++) {
+        if (!(block_pages(block) & dirty_pages)) {
+            oled_dirty &= ~((OLED_BLOCK_TYPE)1 << block);
         }
     }
 
-    // Turn on display if it is off
-    oled_on();
+    if (rendered) {
+        // Turn on display if it is off
+        oled_on();
+    }
+}
+#endif
 
-    // Clear dirty flag
-    oled_dirty &= ~(1 << update_start);
+void oled_render(void) {
+    // Do we have work to do?
+    if (!oled_dirty || oled_scrolling) {
+        return;
+    }
+
+#ifdef OLED_SHADOW_ENABLE
+    render_changes();
+#else
+    render_blocks();
+#endif
 }
 
 void oled_set_cursor(uint8_t col, uint8_t line) {
@@ -327,11 +541,11 @@ void oled_set_cursor(uint8_t col, uint8_t line) {
         index = 0;
     }
 
-    oled_cursor = &oled_buffer[index];
+    oled_cursor = index;
 }
 
 void oled_advance_page(bool clearPageRemainder) {
-    uint16_t index     = oled_cursor - &oled_buffer[0];
+    uint16_t index     = oled_cursor;
     uint8_t  remaining = oled_rotation_width - (index % oled_rotation_width);
 
     if (clearPageRemainder) {
@@ -347,12 +561,12 @@ void oled_advance_page(bool clearPageRemainder) {
             remaining = 0;
         }
 
-        oled_cursor = &oled_buffer[index + remaining];
+        oled_cursor = index + remaining;
     }
 }
 
 void oled_advance_char(void) {
-    uint16_t nextIndex      = oled_cursor - &oled_buffer[0] + OLED_FONT_WIDTH;
+    uint16_t nextIndex      = oled_cursor + OLED_FONT_WIDTH;
     uint8_t  remainingSpace = oled_rotation_width - (nextIndex % oled_rotation_width);
 
     // Do we have enough space on the current line for the next character
@@ -366,7 +580,7 @@ void oled_advance_char(void) {
     }
 
     // Update cursor position
-    oled_cursor = &oled_buffer[nextIndex];
+    oled_cursor = nextIndex;
 }
 
 // Main handler that writes character data to the display buffer
@@ -383,32 +597,17 @@ void oled_write_char(const char data, bool invert) {
         return;
     }
 
-    // copy the current render buffer to check for dirty after
-    static uint8_t oled_temp_buffer[OLED_FONT_WIDTH];
-    memcpy(&oled_temp_buffer, oled_cursor, OLED_FONT_WIDTH);
-
     _Static_assert(sizeof(font) >= ((OLED_FONT_END + 1 - OLED_FONT_START) * OLED_FONT_WIDTH), "OLED_FONT_END references outside array");
 
-    // set the reder buffer data
-    uint8_t cast_data = (uint8_t)data;  // font based on unsigned type for index
-    if (cast_data < OLED_FONT_START || cast_data > OLED_FONT_END) {
-        memset(oled_cursor, 0x00, OLED_FONT_WIDTH);
-    } else {
-        const uint8_t *glyph = &font[(cast_data - OLED_FONT_START) * OLED_FONT_WIDTH];
-        memcpy_P(oled_cursor, glyph, OLED_FONT_WIDTH);
+    // set the reder buffer data, inverted if needed
+    uint8_t        cast_data = (uint8_t)data;  // font based on unsigned type for index
+    const uint8_t *glyph     = NULL;
+    if (cast_data >= OLED_FONT_START && cast_data <= OLED_FONT_END) {
+        glyph = &font[(cast_data - OLED_FONT_START) * OLED_FONT_WIDTH];
     }
-
-    // Invert if needed
-    if (invert) {
-        InvertCharacter(oled_cursor);
-    }
-
-    // Dirty check
-    if (memcmp(&oled_temp_buffer, oled_cursor, OLED_FONT_WIDTH)) {
-        uint16_t index = oled_cursor - &oled_buffer[0];
-        oled_dirty |= (1 << (index / OLED_BLOCK_SIZE));
-        // Edgecase check if the written data spans the 2 chunks
-        oled_dirty |= (1 << ((index + OLED_FONT_WIDTH) / OLED_BLOCK_SIZE));
+    for (uint8_t i = 0; i < OLED_FONT_WIDTH; i++) {
+        uint8_t column = glyph ? pgm_read_byte(&glyph[i]) : 0x00;
+        write_byte(oled_cursor + i, invert ? ~column : column);
     }
 
     // Finally move to the next char
@@ -447,18 +646,14 @@ void oled_pan(bool left) {
 }
 
 void oled_write_raw_byte(const char data, uint16_t index) {
-    if (index > OLED_MATRIX_SIZE) index = OLED_MATRIX_SIZE;
-    if (oled_buffer[index] == data) return;
-    oled_buffer[index] = data;
-    oled_dirty |= (1 << (index / OLED_BLOCK_SIZE));
+    if (index >= OLED_MATRIX_SIZE) return;
+    write_byte(index, data);
 }
 
 void oled_write_raw(const char *data, uint16_t size) {
     if (size > OLED_MATRIX_SIZE) size = OLED_MATRIX_SIZE;
     for (uint16_t i = 0; i < size; i++) {
-        if (oled_buffer[i] == data[i]) continue;
-        oled_buffer[i] = data[i];
-        oled_dirty |= (1 << (i / OLED_BLOCK_SIZE));
+        write_byte(i, data[i]);
     }
 }
 
@@ -479,10 +674,7 @@ void oled_write_ln_P(const char *data, bool invert) {
 void oled_write_raw_P(const char *data, uint16_t size) {
     if (size > OLED_MATRIX_SIZE) size = OLED_MATRIX_SIZE;
     for (uint16_t i = 0; i < size; i++) {
-        uint8_t c = pgm_read_byte(++data);
-        if (oled_buffer[i] == c) continue;
-        oled_buffer[i] = c;
-        oled_dirty |= (1 << (i / OLED_BLOCK_SIZE));
+        write_byte(i, pgm_read_byte(data++));
     }
 }
 #endif  // defined(__AVR__)
@@ -577,6 +769,10 @@ bool oled_scroll_off(void) {
         }
         oled_scrolling = false;
         oled_dirty     = -1;
+#ifdef OLED_SHADOW_ENABLE
+        // Scrolling moved the contents of the panel around
+        invalidate_pages(0xFF);
+#endif
     }
     return !oled_scrolling;
 }
@@ -48,26 +48,6 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #    ifndef OLED_COM_PINS
 #        define OLED_COM_PINS COM_PINS_ALT
 #    endif
-
-// For 90 degree rotation, we map our internal matrix to oled matrix using fixed arrays
-// The OLED writes to it's memory horizontally, starting top left, but our memory starts bottom left in this mode
-#    ifndef OLED_SOURCE_MAP
-#        define OLED_SOURCE_MAP \
-            { 0, 8, 16, 24, 32, 40, 48, 56 }
-#    endif
-#    ifndef OLED_TARGET_MAP
-#        define OLED_TARGET_MAP \
-            { 56, 48, 40, 32, 24, 16, 8, 0 }
-#    endif
-// If OLED_BLOCK_TYPE is uint32_t, these tables would look like:
-// #define OLED_SOURCE_MAP { 32, 40, 48, 56 }
-// #define OLED_TARGET_MAP { 24, 16, 8, 0 }
-// If OLED_BLOCK_TYPE is uint16_t, these tables would look like:
-// #define OLED_SOURCE_MAP { 0, 8, 16, 24, 32, 40, 48, 56 }
-// #define OLED_TARGET_MAP { 56, 48, 40, 32, 24, 16, 8, 0 }
-// If OLED_BLOCK_TYPE is uint8_t, these tables would look like:
-// #define OLED_SOURCE_MAP { 0, 8, 16, 24, 32, 40, 48, 56, 64, 72, 80, 88, 96, 104, 112, 120 }
-// #define OLED_TARGET_MAP { 56, 120, 48, 112, 40, 104, 32, 96, 24, 88, 16, 80, 8, 72, 0, 64 }
 #else  // defined(OLED_DISPLAY_128X64)
 // Default 128x32
 #    ifndef OLED_DISPLAY_WIDTH
@@ -91,20 +71,6 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #    ifndef OLED_COM_PINS
 #        define OLED_COM_PINS COM_PINS_SEQ
 #    endif
-
-// For 90 degree rotation, we map our internal matrix to oled matrix using fixed arrays
-// The OLED writes to it's memory horizontally, starting top left, but our memory starts bottom left in this mode
-#    ifndef OLED_SOURCE_MAP
-#        define OLED_SOURCE_MAP \
-            { 0, 8, 16, 24 }
-#    endif
-#    ifndef OLED_TARGET_MAP
-#        define OLED_TARGET_MAP \
-            { 24, 16, 8, 0 }
-#    endif
-// If OLED_BLOCK_TYPE is uint8_t, these tables would look like:
-// #define OLED_SOURCE_MAP { 0, 8, 16, 24, 32, 40, 48, 56 }
-// #define OLED_TARGET_MAP { 48, 32, 16, 0, 56, 40, 24, 8 }
 #endif  // defined(OLED_DISPLAY_CUSTOM)
 
 #if !defined(OLED_IC)
@@ -142,6 +108,19 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #    define OLED_FONT_HEIGHT 8
 #endif
 
+// Maximum number of display bytes oled_render sends per call
+#if !defined(OLED_RENDER_LIMIT)
+#    if defined(I2C_QUEUE_ENABLE)
+#        define OLED_RENDER_LIMIT (I2C_QUEUE_BUFFER_SIZE - 1)
+#    else
+#        define OLED_RENDER_LIMIT OLED_DISPLAY_WIDTH
+#    endif
+#endif
+// Changed runs in a page separated by up to this many unchanged columns are sent together
+#if !defined(OLED_RENDER_MERGE_GAP)
+#    define OLED_RENDER_MERGE_GAP 8
+#endif
+
 #if !defined(OLED_TIMEOUT)
 #    if defined(OLED_DISABLE_TIMEOUT)
 #        define OLED_TIMEOUT 0
@@ -0,0 +1,186 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+extern "C" {
+#include "oled_driver.h"
+#include "i2c_master.h"
+}
+
+// Mock SSD1306: keeps the display RAM up to date using the column and page
+// windows set by the driver, in horizontal addressing mode
+static uint8_t  panel[OLED_MATRIX_SIZE];
+static uint8_t  column_start, column_end, page_start, page_end;
+static uint8_t  column, page;
+static uint32_t data_bytes;
+
+extern "C" {
+uint32_t timer_read32(void) { return 0; }
+
+void i2c_init(void) {}
+
+i2c_status_t i2c_transmit(uint8_t address, const uint8_t* data, uint16_t length, uint16_t timeout) {
+    // Bounds command: {I2C_CMD, COLUMN_ADDR, start, end, PAGE_ADDR, start, end}
+    if (length == 7 && data[0] == 0x00 && data[1] == 0x21 && data[4] == 0x22) {
+        column_start = column = data[2];
+        column_end            = data[3];
+        page_start = page = data[5];
+        page_end          = data[6];
+    }
+    return I2C_STATUS_SUCCESS;
+}
+
+i2c_status_t i2c_writeReg(uint8_t devaddr, uint8_t regaddr, const uint8_t* data, uint16_t length, uint16_t timeout) {
+    for (uint16_t i = 0; i < length; i++) {
+        panel[page * OLED_DISPLAY_WIDTH + column] = data[i];
+        if (++column > column_end) {
+            column = column_start;
+            if (++page > page_end) {
+                page = page_start;
+            }
+        }
+    }
+    data_bytes += length;
+    return I2C_STATUS_SUCCESS;
+}
+}
+
+class OledDriver : public testing::Test {
+   public:
+    OledDriver() {
+        memset(panel, 0x55, sizeof(panel));
+        column_start = column = page_start = page = 0;
+        column_end                                = OLED_DISPLAY_WIDTH - 1;
+        page_end                                  = OLED_DISPLAY_HEIGHT / 8 - 1;
+    }
+
+    static void render(void) {
+        data_bytes = 0;
+        for (uint16_t i = 0; i < OLED_MATRIX_SIZE; i++) {
+            oled_render();
+        }
+    }
+
+    // The panel contents as text, one character per pixel, in the orientation
+    // of the display RAM
+    static std::string image(void) {
+        std::string image;
+        for (uint8_t y = 0; y < OLED_DISPLAY_HEIGHT; y++) {
+            for (uint8_t x = 0; x < OLED_DISPLAY_WIDTH; x++) {
+                image += (panel[y / 8 * OLED_DISPLAY_WIDTH + x] & (1 << (y % 8))) ? '#' : '.';
+            }
+            image += '\n';
+        }
+        return image;
+    }
+
+    // Set OLED_UPDATE_GOLDEN to rewrite the golden images instead of
+    // comparing against them
+    static void expect_golden(const std::string& name) {
+        std::string path = std::string(__FILE__);
+        path             = path.substr(0, path.find_last_of('/') + 1) + "golden/" + name + ".txt";
+
+        if (getenv("OLED_UPDATE_GOLDEN")) {
+            std::ofstream(path) << image();
+            return;
+        }
+
+        std::ifstream     file(path);
+        std::stringstream golden;
+        golden << file.rdbuf();
+        ASSERT_TRUE(file.good());
+        EXPECT_EQ(image(), golden.str());
+    }
+
+    static void draw_text(void) {
+        oled_write_ln("Hello, world!", false);
+        oled_write("Inverted", true);
+        oled_set_cursor(1, 2);
+        oled_write_char('Q', false);
+        oled_advance_page(false);
+        oled_write("0123456789", false);
+    }
+
+    static void draw_pattern(void) {
+        static char pattern[OLED_MATRIX_SIZE];
+        for (uint16_t i = 0; i < OLED_MATRIX_SIZE; i++) {
+            pattern[i] = (i * 37) ^ (i >> 3);
+        }
+        oled_write_raw(pattern, sizeof(pattern));
+        oled_write_raw_byte(0xFF, 5);
+    }
+};
+
+TEST_F(OledDriver, renders_text) {
+    ASSERT_TRUE(oled_init(OLED_ROTATION_0));
+    draw_text();
+    render();
+    expect_golden("text_rotation_0");
+}
+
+TEST_F(OledDriver, renders_rotated_text) {
+    ASSERT_TRUE(oled_init(OLED_ROTATION_90));
+    draw_text();
+    render();
+    expect_golden("text_rotation_90");
+}
+
+TEST_F(OledDriver, renders_raw_data) {
+    ASSERT_TRUE(oled_init(OLED_ROTATION_0));
+    draw_pattern();
+    render();
+    expect_golden("raw_rotation_0");
+}
+
+TEST_F(OledDriver, renders_rotated_raw_data) {
+    ASSERT_TRUE(oled_init(OLED_ROTATION_90));
+    draw_pattern();
+    render();
+    expect_golden("raw_rotation_90");
+}
+
+TEST_F(OledDriver, only_sends_what_changed) {
+    ASSERT_TRUE(oled_init(OLED_ROTATION_0));
+    draw_text();
+    render();
+
+    oled_set_cursor(0, 0);
+    oled_write("Jello", false);
+    render();
+    EXPECT_GT(data_bytes, 0u);
+    EXPECT_LE(data_bytes, OLED_FONT_WIDTH);
+
+    render();
+    EXPECT_EQ(data_bytes, 0u);
+}
+
+TEST_F(OledDriver, only_sends_what_changed_when_rotated) {
+    ASSERT_TRUE(oled_init(OLED_ROTATION_90));
+    draw_text();
+    render();
+
+    oled_set_cursor(0, 0);
+    oled_write("Jello", false);
+    render();
+    // A character is 8 columns wide once rotated
+    EXPECT_GT(data_bytes, 0u);
+    EXPECT_LE(data_bytes, 8u);
+}
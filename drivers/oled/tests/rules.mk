@@ -0,0 +1,9 @@
+oled_driver_SRC :=\
+	$(DRIVER_PATH)/oled/tests/oled_driver_tests.cpp \
+	$(DRIVER_PATH)/oled/oled_driver.c
+
+oled_driver_INC :=\
+	$(TOP_DIR)/tests/test_common \
+	$(DRIVER_PATH)/oled
+
+oled_driver_DEFS := -DNO_PRINT -DOLED_SHADOW_ENABLE
@@ -14,6 +14,7 @@
 #    include "src/gdisp/gdisp_driver.h"
 
 #    include "board_st7565.h"
+#    include "lcd_compositor.h"
 
 /*===========================================================================*/
 /* Driver local definitions.                                                 */
@@ -57,15 +58,18 @@
 /*===========================================================================*/
 
 typedef struct {
-    bool_t  buffer2;
-    uint8_t data_pos;
-    uint8_t data[16];
-    uint8_t ram[GDISP_SCREEN_HEIGHT * GDISP_SCREEN_WIDTH / 8];
+    bool_t           buffer2;
+    uint8_t          data_pos;
+    uint8_t          data[16];
+    uint8_t          ram[GDISP_SCREEN_HEIGHT * GDISP_SCREEN_WIDTH / 8];
+    uint8_t          shown[2][GDISP_SCREEN_HEIGHT * GDISP_SCREEN_WIDTH / 8];
+    lcd_compositor_t compositor;
 } PrivData;
 
 // Some common routines and macros
 #    define PRIV(g) ((PrivData *)g->priv)
 #    define RAM(g) (PRIV(g)->ram)
+#    define COMPOSITOR(g) (&PRIV(g)->compositor)
 
 static GFXINLINE void write_cmd(GDisplay *g, uint8_t cmd) { PRIV(g)->data[PRIV(g)->data_pos++] = cmd; }
 
@@ -109,6 +113,9 @@ LLDSPEC bool_t gdisp_lld_init(GDisplay *g) {
     g->priv           = gfxAlloc(sizeof(PrivData));
     PRIV(g)->buffer2  = false;
     PRIV(g)->data_pos = 0;
+    // The display holds two frames, in pages 0-3 and 4-7
+    lcd_compositor_init(COMPOSITOR(g), RAM(g), &PRIV(g)->shown[0][0], GDISP_SCREEN_WIDTH, GDISP_SCREEN_HEIGHT, 2);
+    lcd_compositor = COMPOSITOR(g);
 
     // Initialise the board interface
     init_board(g);
@@ -156,25 +163,27 @@ LLDSPEC bool_t gdisp_lld_init(GDisplay *g) {
 }
 
 #    if GDISP_HARDWARE_FLUSH
-LLDSPEC void gdisp_lld_flush(GDisplay *g) {
-    unsigned p;
+static void push_span(void *context, uint8_t page, uint8_t column, const uint8_t *data, uint8_t length) {
+    GDisplay *g         = (GDisplay *)context;
+    unsigned  dstOffset = (PRIV(g)->buffer2 ? 4 : 0);
+    write_cmd(g, ST7565_PAGE | (page + dstOffset));
+    write_cmd(g, ST7565_COLUMN_MSB | (column >> 4));
+    write_cmd(g, ST7565_COLUMN_LSB | (column & 0x0F));
+    write_cmd(g, ST7565_RMW);
+    flush_cmd(g);
+    enter_data_mode(g);
+    write_data(g, (uint8_t *)data, length);
+    enter_cmd_mode(g);
+}
 
+LLDSPEC void gdisp_lld_flush(GDisplay *g) {
     // Don't flush if we don't need it.
     if (!(g->flags & GDISP_FLG_NEEDFLUSH)) return;
 
     acquire_bus(g);
     enter_cmd_mode(g);
-    unsigned dstOffset = (PRIV(g)->buffer2 ? 4 : 0);
-    for (p = 0; p < 4; p++) {
-        write_cmd(g, ST7565_PAGE | (p + dstOffset));
-        write_cmd(g, ST7565_COLUMN_MSB | 0);
-        write_cmd(g, ST7565_COLUMN_LSB | 0);
-        write_cmd(g, ST7565_RMW);
-        flush_cmd(g);
-        enter_data_mode(g);
-        write_data(g, RAM(g) + (p * GDISP_SCREEN_WIDTH), GDISP_SCREEN_WIDTH);
-        enter_cmd_mode(g);
-    }
+    // Only what has changed since the back buffer was last written is sent
+    lcd_compositor_push(COMPOSITOR(g), push_span, g);
     unsigned line = (PRIV(g)->buffer2 ? 32 : 0);
     write_cmd(g, ST7565_START_LINE | line);
     flush_cmd(g);
@@ -212,6 +221,7 @@ LLDSPEC void gdisp_lld_draw_pixel(GDisplay *g) {
         RAM(g)[xyaddr(x, y)] |= xybit(y);
     else
         RAM(g)[xyaddr(x, y)] &= ~xybit(y);
+    lcd_compositor_damage(COMPOSITOR(g), x, y, 1, 1);
     g->flags |= GDISP_FLG_NEEDFLUSH;
 }
 #    endif
@@ -266,6 +276,7 @@ LLDSPEC void gdisp_lld_blit_area(GDisplay *g) {
             srcbit++;
         }
     }
+    lcd_compositor_damage(COMPOSITOR(g), g->p.x, g->p.y, g->p.cx, g->p.cy);
     g->flags |= GDISP_FLG_NEEDFLUSH;
 }
 
@@ -220,19 +220,13 @@ void pointing_device_task(void) {
     if(!is_keyboard_master())
         return;
 
-    report_mouse_t report = pointing_device_get_report();
-
-    // clamp deltas from -127 to 127
-    report.x = delta_x < -127 ? 127 : delta_x > 127 ? 127 : delta_x;
-    report.x = -report.x;
-
-    report.y = delta_y < -127 ? 127 : delta_y > 127 ? 127 : delta_y;
+    // deltas larger than a report can hold are carried over to the next ones
+    pointing_device_move(-delta_x, delta_y);
 
     // reset deltas
     delta_x = 0;
     delta_y = 0;
 
-    pointing_device_set_report(report);
     pointing_device_send();
 }
 
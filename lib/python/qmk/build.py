@@ -0,0 +1,210 @@
+"""Build many keyboard/keymap targets at once.
+
+The top level Makefile runs the targets of a rule like `all:default` one after the other. Here make is only asked which targets a rule covers, and then a make is run for each of them, several at a time.
+"""
+import json
+import re
+import subprocess
+import threading
+import time
+from pathlib import Path
+
+from qmk.commands import run
+
+# A line printed by `make <rule> LIST_TARGETS=yes`, such as planck/rev6:default
+TARGET_LINE = re.compile(r'^([\w.+/-]+):([\w.+-]+)$')
+
+# Printed by build_keyboard.mk once the firmware is in the qmk_firmware folder
+FIRMWARE_LINE = re.compile(r'Copying (\S+) to qmk_firmware folder')
+
+
+def list_targets(rule):
+    """Ask make which keyboard/keymap pairs a rule expands to.
+
+    This is also the one make that writes quantum/version.h and checks the submodules, the builds started by `build_targets()` skip both.
+
+    Args:
+
+        rule
+            A make rule such as `all:default` or `planck/rev6:all`
+
+    Returns:
+
+        A list of (keyboard, keymap) tuples, and anything else make printed
+    """
+    result = run(['make', '-s', rule, 'LIST_TARGETS=yes'], stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+    targets = []
+    messages = []
+
+    for line in result.stdout.splitlines():
+        match = TARGET_LINE.match(line.strip())
+        if match:
+            targets.append(match.groups())
+        elif line.strip():
+            messages.append(line)
+
+    return targets, messages
+
+
+def firmware_size(firmware):
+    """Returns the number of bytes that would be flashed from a firmware file.
+
+    Intel hex files are counted by their data records, anything else by its size on disk.
+    """
+    firmware = Path(firmware)
+
+    if firmware.suffix != '.hex':
+        return firmware.stat().st_size
+
+    size = 0
+    for line in firmware.read_text().splitlines():
+        # :LLAAAATT, a data record has type 00
+        if line.startswith(':') and line[7:9] == '00':
+            size += int(line[1:3], 16)
+
+    return size
+
+
+class BuildResult:
+    """The outcome of building one target.
+    """
+    def __init__(self, keyboard, keymap, log):
+        self.keyboard = keyboard
+        self.keymap = keymap
+        self.log = log
+        self.returncode = None
+        self.seconds = 0.0
+        self.firmware = None
+        self.size = None
+
+    @property
+    def target(self):
+        return '%s:%s' % (self.keyboard, self.keymap)
+
+    @property
+    def ok(self):
+        return self.returncode == 0
+
+    def as_dict(self):
+        return {
+            'keyboard': self.keyboard,
+            'keymap': self.keymap,
+            'ok': self.ok,
+            'returncode': self.returncode,
+            'seconds': round(self.seconds, 2),
+            'firmware': self.firmware,
+            'size': self.size,
+            'log': str(self.log),
+        }
+
+
+def build_target(result):
+    """Runs make for one target, writing everything it prints to `result.log` as it goes.
+    """
+    error_file = result.log.with_suffix('.error')
+    command = [
+        'make',
+        result.target,
+        'COLOR=false',
+        # version.h was written by list_targets(), and there's no need to check the submodules for every target
+        'SKIP_GIT=yes',
+        'KEEP_VERSION_H=yes',
+        # Each make removes and checks its error file, so they can't share one
+        'ERROR_FILE=%s' % error_file.resolve(),
+    ]
+
+    start = time.monotonic()
+    with result.log.open('w') as log:
+        result.returncode = run(command, stdout=log, stderr=subprocess.STDOUT, stdin=subprocess.DEVNULL).returncode
+    result.seconds = time.monotonic() - start
+
+    if error_file.exists():
+        error_file.unlink()
+
+    if result.ok:
+        match = FIRMWARE_LINE.search(result.log.read_text(errors='replace'))
+        if match and Path(match.group(1)).exists():
+            result.firmware = match.group(1)
+            result.size = firmware_size(match.group(1))
+
+    return result
+
+
+def build_targets(targets, jobs, log_dir, on_done=None, builder=build_target):
+    """Builds targets with up to `jobs` makes running at the same time.
+
+    The targets of one keyboard share its object folder, .build/obj_<keyboard>, so only one of them is built at a time. Targets are started in the order they are given, skipping over the ones whose keyboard is busy.
+
+    Args:
+
+        targets
+            A list of (keyboard, keymap) tuples
+
+        jobs
+            How many makes to run at the same time
+
+        log_dir
+            Where each target's log goes, as <keyboard>_<keymap>.log
+
+        on_done
+            Called with each BuildResult as it finishes
+
+    Returns:
+
+        A list of BuildResult, in the same order as `targets`
+    """
+    log_dir = Path(log_dir)
+    log_dir.mkdir(parents=True, exist_ok=True)
+
+    results = [BuildResult(keyboard, keymap, log_dir / ('%s_%s.log' % (keyboard.replace('/', '_'), keymap))) for keyboard, keymap in targets]
+    pending = list(results)
+    busy_keyboards = set()
+    condition = threading.Condition()
+
+    def next_result():
+        """Takes the first pending target whose keyboard is free, waiting for one if they are all busy.
+        """
+        with condition:
+            while pending:
+                for index, result in enumerate(pending):
+                    if result.keyboard not in busy_keyboards:
+                        busy_keyboards.add(result.keyboard)
+                        return pending.pop(index)
+                condition.wait()
+        return None
+
+    def worker():
+        result = next_result()
+        while result:
+            builder(result)
+            with condition:
+                busy_keyboards.discard(result.keyboard)
+                if on_done:
+                    on_done(result)
+                condition.notify_all()
+            result = next_result()
+
+    workers = [threading.Thread(target=worker) for i in range(max(1, jobs))]
+    for thread in workers:
+        thread.start()
+    for thread in workers:
+        thread.join()
+
+    return results
+
+
+def write_summary(summary_file, rule, jobs, seconds, results):
+    """Writes a JSON file with the time, firmware and size of every target.
+    """
+    summary = {
+        'rule': rule,
+        'jobs': jobs,
+        'seconds': round(seconds, 2),
+        'built': sum(1 for result in results if result.ok),
+        'failed': sum(1 for result in results if not result.ok),
+        'targets': [result.as_dict() for result in results],
+    }
+
+    summary_file = Path(summary_file)
+    summary_file.parent.mkdir(parents=True, exist_ok=True)
+    summary_file.write_text(json.dumps(summary, indent=4) + '\n')
@@ -3,10 +3,12 @@
 You can compile a keymap already in the repo or using a QMK Configurator export.
 """
 import subprocess
+import time
 from argparse import FileType
 
 from milc import cli
 
+import qmk.build
 import qmk.path
 from qmk.decorators import automagic_keyboard, automagic_keymap
 from qmk.commands import compile_configurator_json, create_make_command, parse_configurator_json
@@ -16,6 +18,9 @@ from qmk.commands import compile_configurator_json, create_make_command, parse_c
 @cli.argument('-kb', '--keyboard', help='The keyboard to build a firmware for. Ignored when a configurator export is supplied.')
 @cli.argument('-km', '--keymap', help='The keymap to build a firmware for. Ignored when a configurator export is supplied.')
 @cli.argument('-n', '--dry-run', arg_only=True, action='store_true', help="Don't actually build, just show the make command to be run.")
+@cli.argument('-j', '--parallel', arg_only=True, type=int, default=0, help='Build every target of the keyboard and keymap, either of which can be `all`, running this many makes at a time.')
+@cli.argument('--log-dir', arg_only=True, default='.build/logs', help='Where the log of each target goes when building with --parallel.')
+@cli.argument('--summary', arg_only=True, default='.build/summary.json', help='Where the JSON summary of the build goes when building with --parallel.')
 @cli.subcommand('Compile a QMK Firmware.')
 @automagic_keyboard
 @automagic_keymap
@@ -25,6 +30,8 @@ def compile(cli):
     If a Configurator export is supplied this command will create a new keymap, overwriting an existing keymap if one exists.
 
     If a keyboard and keymap are provided this command will build a firmware based on that.
+
+    With --parallel the targets are built several at a time, each with its own log, followed by a summary of how long each took and how big its firmware is.
     """
     command = None
 
@@ -38,7 +45,10 @@ def compile(cli):
         cli.log.info('Wrote keymap to {fg_cyan}%s/%s/keymap.c', keymap_path, user_keymap['keymap'])
 
     else:
-        if cli.config.compile.keyboard and cli.config.compile.keymap:
+        if cli.config.compile.keyboard and cli.config.compile.keymap and cli.args.parallel:
+            return compile_parallel(cli.config.compile.keyboard, cli.config.compile.keymap)
+
+        elif cli.config.compile.keyboard and cli.config.compile.keymap:
             # Generate the make command for a specific keyboard/keymap.
             command = create_make_command(cli.config.compile.keyboard, cli.config.compile.keymap)
 
@@ -56,5 +66,45 @@ def compile(cli):
 
     else:
         cli.log.error('You must supply a configurator export, both `--keyboard` and `--keymap`, or be in a directory for a keyboard or keymap.')
-        cli.echo('usage: qmk compile [-h] [-b] [-kb KEYBOARD] [-km KEYMAP] [filename]')
+        cli.echo('usage: qmk compile [-h] [-b] [-j PARALLEL] [-kb KEYBOARD] [-km KEYMAP] [filename]')
+        return False
+
+
+def compile_parallel(keyboard, keymap):
+    """Build every target of `make <keyboard>:<keymap>`, with --parallel makes at a time.
+    """
+    rule = '%s:%s' % (keyboard, keymap)
+    targets, messages = qmk.build.list_targets(rule)
+
+    for message in messages:
+        cli.echo('%s', message)
+
+    if not targets:
+        cli.log.error('No keyboard and keymap matches {fg_cyan}%s', rule)
         return False
+
+    cli.log.info('Compiling {fg_cyan}%d{fg_reset} targets of {fg_cyan}%s{fg_reset}, %d at a time', len(targets), rule, cli.args.parallel)
+
+    if cli.args.dry_run:
+        for target in targets:
+            cli.echo('%s:%s', *target)
+        return True
+
+    finished = []
+
+    def report(result):
+        finished.append(result)
+        if result.ok:
+            cli.log.info('[%d/%d] {fg_green}%s{fg_reset} in %.1f s, %s bytes', len(finished), len(targets), result.target, result.seconds, result.size)
+        else:
+            cli.log.error('[%d/%d] {fg_red}%s{fg_reset} failed, see %s', len(finished), len(targets), result.target, result.log)
+
+    start = time.monotonic()
+    results = qmk.build.build_targets(targets, cli.args.parallel, cli.args.log_dir, report)
+    seconds = time.monotonic() - start
+    qmk.build.write_summary(cli.args.summary, rule, cli.args.parallel, seconds, results)
+
+    failed = [result for result in results if not result.ok]
+    cli.log.info('Compiled %d of %d targets in %.1f s, summary written to {fg_cyan}%s', len(results) - len(failed), len(results), seconds, cli.args.summary)
+
+    return not failed
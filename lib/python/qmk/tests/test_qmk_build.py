@@ -0,0 +1,47 @@
+import threading
+import time
+
+import qmk.build
+
+
+def test_list_targets_onekey_pytest():
+    targets, messages = qmk.build.list_targets('handwired/onekey/pytest:default')
+    assert targets == [('handwired/onekey/pytest', 'default')]
+
+
+def test_firmware_size_hex(tmp_path):
+    firmware = tmp_path / 'test.hex'
+    firmware.write_text(':020000040000FA\n:10000000000102030405060708090A0B0C0D0E0F78\n:04001000101112135E\n:00000001FF\n')
+    assert qmk.build.firmware_size(firmware) == 20
+
+
+def test_firmware_size_bin(tmp_path):
+    firmware = tmp_path / 'test.bin'
+    firmware.write_bytes(bytes(1234))
+    assert qmk.build.firmware_size(firmware) == 1234
+
+
+def test_build_targets_one_per_keyboard(tmp_path):
+    targets = [('a', 'one'), ('a', 'two'), ('b', 'one'), ('c', 'one'), ('a', 'three')]
+    lock = threading.Lock()
+    building = []
+    overlaps = []
+    finished = []
+
+    def builder(result):
+        with lock:
+            if result.keyboard in building:
+                overlaps.append(result.target)
+            building.append(result.keyboard)
+        time.sleep(0.01)
+        with lock:
+            building.remove(result.keyboard)
+        result.returncode = 1 if result.keymap == 'two' else 0
+
+    results = qmk.build.build_targets(targets, 4, tmp_path, finished.append, builder)
+
+    assert overlaps == []
+    assert len(finished) == len(targets)
+    assert [(result.keyboard, result.keymap) for result in results] == targets
+    assert [result.ok for result in results] == [True, False, True, True, True]
+    assert results[0].log == tmp_path / 'a_one.log'
@@ -0,0 +1,294 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "synth.h"
+
+#define SYNTH_SAMPLE_MAX 32767
+
+// One duration unit (a sixteenth of a quarter note at TEMPO_DEFAULT) lasts
+// 32768us, which matches the timing of the AVR audio driver at 16MHz.
+#define SYNTH_NOTE_UNIT_US 32768UL
+
+typedef struct {
+    uint32_t phase;
+    uint32_t increment;  // current base increment, slides towards target
+    uint32_t target;     // increment of the requested frequency
+    uint32_t step;       // increment actually applied, including vibrato
+} synth_voice_t;
+
+static const int16_t sine_table[256] = {
+    0,      804,    1608,   2410,   3212,   4011,   4808,   5602,   6393,   7179,   7962,   8739,   9512,   10278,  11039,  11793,
+    12539,  13279,  14010,  14732,  15446,  16151,  16846,  17530,  18204,  18868,  19519,  20159,  20787,  21403,  22005,  22594,
+    23170,  23731,  24279,  24811,  25329,  25832,  26319,  26790,  27245,  27683,  28105,  28510,  28898,  29268,  29621,  29956,
+    30273,  30571,  30852,  31113,  31356,  31580,  31785,  31971,  32137,  32285,  32412,  32521,  32609,  32678,  32728,  32757,
+    32767,  32757,  32728,  32678,  32609,  32521,  32412,  32285,  32137,  31971,  31785,  31580,  31356,  31113,  30852,  30571,
+    30273,  29956,  29621,  29268,  28898,  28510,  28105,  27683,  27245,  26790,  26319,  25832,  25329,  24811,  24279,  23731,
+    23170,  22594,  22005,  21403,  20787,  20159,  19519,  18868,  18204,  17530,  16846,  16151,  15446,  14732,  14010,  13279,
+    12539,  11793,  11039,  10278,  9512,   8739,   7962,   7179,   6393,   5602,   4808,   4011,   3212,   2410,   1608,   804,
+    0,      -804,   -1608,  -2410,  -3212,  -4011,  -4808,  -5602,  -6393,  -7179,  -7962,  -8739,  -9512,  -10278, -11039, -11793,
+    -12539, -13279, -14010, -14732, -15446, -16151, -16846, -17530, -18204, -18868, -19519, -20159, -20787, -21403, -22005, -22594,
+    -23170, -23731, -24279, -24811, -25329, -25832, -26319, -26790, -27245, -27683, -28105, -28510, -28898, -29268, -29621, -29956,
+    -30273, -30571, -30852, -31113, -31356, -31580, -31785, -31971, -32137, -32285, -32412, -32521, -32609, -32678, -32728, -32757,
+    -32767, -32757, -32728, -32678, -32609, -32521, -32412, -32285, -32137, -31971, -31785, -31580, -31356, -31113, -30852, -30571,
+    -30273, -29956, -29621, -29268, -28898, -28510, -28105, -27683, -27245, -26790, -26319, -25832, -25329, -24811, -24279, -23731,
+    -23170, -22594, -22005, -21403, -20787, -20159, -19519, -18868, -18204, -17530, -16846, -16151, -15446, -14732, -14010, -13279,
+    -12539, -11793, -11039, -10278, -9512,  -8739,  -7962,  -7179,  -6393,  -5602,  -4808,  -4011,  -3212,  -2410,  -1608,  -804,
+};
+
+static synth_voice_t    voices[SYNTH_MAX_VOICES];
+static uint8_t          voice_count;
+static uint16_t         mix_gain;
+static uint32_t         sample_rate;
+static float            increment_scale;
+static uint32_t         note_unit;
+static uint16_t         control_countdown;
+static synth_waveform_t waveform = SYNTH_WAVE_SQUARE;
+static uint8_t          duty     = 128;
+static bool             glissando;
+static uint16_t         vibrato_rate;
+static uint8_t          vibrato_depth;
+static uint16_t         vibrato_phase;
+
+static float (*song_notes)[][2];
+static uint16_t song_count;
+static uint16_t song_index;
+static uint8_t  song_tempo;
+static bool     song_repeat;
+static bool     song_playing;
+static bool     song_resting;
+static uint32_t song_remaining;
+
+static void update_gain(void) { mix_gain = voice_count ? 256 / voice_count : 0; }
+
+void synth_init(uint32_t rate) {
+    sample_rate     = rate;
+    increment_scale = 4294967296.0f / (float)rate;
+    note_unit       = (rate * SYNTH_NOTE_UNIT_US) / 1000000UL;
+
+    synth_stop_all();
+    control_countdown = 0;
+    vibrato_phase     = 0;
+}
+
+uint32_t synth_sample_rate(void) { return sample_rate; }
+
+uint32_t synth_increment(float frequency) { return (uint32_t)(frequency * increment_scale); }
+
+static void voice_set(synth_voice_t *voice, uint32_t increment, bool slide) {
+    voice->target = increment;
+    if (!slide) {
+        voice->increment = increment;
+        voice->step      = increment;
+    }
+}
+
+bool synth_voice_start(float frequency) {
+    if (song_playing) {
+        synth_stop_song();
+    }
+    if (frequency < SYNTH_MIN_FREQUENCY || voice_count >= SYNTH_MAX_VOICES) {
+        return false;
+    }
+
+    synth_voice_t *voice = &voices[voice_count];
+    if (glissando && voice_count > 0) {
+        // Glide from the most recent voice rather than jumping straight in
+        voice->increment = voices[voice_count - 1].increment;
+        voice->step      = voice->increment;
+    }
+    voice_set(voice, synth_increment(frequency), glissando && voice_count > 0);
+    voice->phase = 0;
+
+    voice_count++;
+    update_gain();
+    return true;
+}
+
+void synth_voice_stop(float frequency) {
+    uint32_t increment = synth_increment(frequency);
+
+    for (int8_t i = voice_count - 1; i >= 0; i--) {
+        if (voices[i].target == increment) {
+            for (uint8_t j = i; j < voice_count - 1; j++) {
+                voices[j] = voices[j + 1];
+            }
+            voice_count--;
+            update_gain();
+            return;
+        }
+    }
+}
+
+void synth_stop_all(void) {
+    song_playing = false;
+    voice_count  = 0;
+    update_gain();
+}
+
+uint8_t synth_active_voices(void) { return voice_count; }
+
+void synth_set_waveform(synth_waveform_t new_waveform) { waveform = new_waveform; }
+
+void synth_set_duty(uint8_t new_duty) { duty = new_duty; }
+
+void synth_set_glissando(bool enable) { glissando = enable; }
+
+void synth_set_vibrato(uint16_t rate, uint8_t depth) {
+    vibrato_rate  = rate;
+    vibrato_depth = depth;
+}
+
+static void song_start_note(void) {
+    float    frequency = (*song_notes)[song_index][0];
+    uint32_t duration  = (uint32_t)(*song_notes)[song_index][1];
+
+    song_remaining = duration * song_tempo * note_unit / 400;
+    if (frequency < SYNTH_MIN_FREQUENCY) {
+        voice_count = 0;
+    } else {
+        voice_set(&voices[0], synth_increment(frequency), glissando && voice_count > 0);
+        voice_count = 1;
+    }
+    update_gain();
+}
+
+static void song_advance(void) {
+    uint16_t next = song_index + 1;
+
+    if (next >= song_count) {
+        if (!song_repeat) {
+            synth_stop_all();
+            return;
+        }
+        next = 0;
+    }
+
+    // Repeated notes get a short rest in between, so they don't merge
+    if (!song_resting && (*song_notes)[next][0] == (*song_notes)[song_index][0]) {
+        song_resting   = true;
+        song_remaining = note_unit / 4;
+        voice_count    = 0;
+        update_gain();
+        return;
+    }
+
+    song_resting = false;
+    song_index   = next;
+    song_start_note();
+}
+
+void synth_play_song(float (*notes)[][2], uint16_t count, bool repeat, uint8_t tempo) {
+    synth_stop_all();
+    if (count == 0) {
+        return;
+    }
+
+    song_notes   = notes;
+    song_count   = count;
+    song_index   = 0;
+    song_tempo   = tempo;
+    song_repeat  = repeat;
+    song_resting = false;
+    song_playing = true;
+    song_start_note();
+}
+
+void synth_stop_song(void) {
+    if (song_playing) {
+        synth_stop_all();
+    }
+}
+
+bool synth_is_playing_song(void) { return song_playing; }
+
+static void synth_control(void) {
+    if (song_playing) {
+        if (song_remaining > SYNTH_CONTROL_SAMPLES) {
+            song_remaining -= SYNTH_CONTROL_SAMPLES;
+        } else {
+            song_advance();
+        }
+    }
+
+    int32_t lfo = 0;
+    if (vibrato_depth) {
+        vibrato_phase += vibrato_rate;
+        // Triangle LFO in the range [-32767, 32767]
+        lfo = (vibrato_phase & 0x8000) ? (0xFFFF - vibrato_phase) : vibrato_phase;
+        lfo = lfo * 2 - SYNTH_SAMPLE_MAX;
+    }
+
+    for (uint8_t i = 0; i < voice_count; i++) {
+        synth_voice_t *voice = &voices[i];
+
+        if (voice->increment != voice->target) {
+            int32_t delta = (int32_t)(voice->target - voice->increment) / 8;
+            if (delta == 0) {
+                voice->increment = voice->target;
+            } else {
+                voice->increment += delta;
+            }
+        }
+
+        voice->step = voice->increment;
+        if (vibrato_depth) {
+            int32_t deviation = (int32_t)((voice->increment >> 12) * vibrato_depth);
+            voice->step += (int32_t)(((int64_t)deviation * lfo) >> 15);
+        }
+    }
+}
+
+static inline int16_t synth_wave(uint32_t phase) {
+    switch (waveform) {
+        case SYNTH_WAVE_TRIANGLE: {
+            uint16_t position = phase >> 16;
+            int32_t  level    = (position & 0x8000) ? (0xFFFF - position) : position;
+            return level * 2 - SYNTH_SAMPLE_MAX;
+        }
+        case SYNTH_WAVE_SAWTOOTH:
+            return (int32_t)(phase >> 16) - 32768;
+        case SYNTH_WAVE_SINE:
+            return sine_table[phase >> 24];
+        case SYNTH_WAVE_SQUARE:
+        default:
+            return (phase >> 24) < duty ? SYNTH_SAMPLE_MAX : -SYNTH_SAMPLE_MAX;
+    }
+}
+
+/*
+ * Renders length signed 16-bit samples into buffer, advancing all voices and
+ * the song sequencer. Returns false once there is nothing left to play, so the
+ * caller can stop its sample clock.
+ */
+bool synth_render(int16_t *buffer, uint16_t length) {
+    for (uint16_t i = 0; i < length; i++) {
+        if (control_countdown == 0) {
+            synth_control();
+            control_countdown = SYNTH_CONTROL_SAMPLES;
+        }
+        control_countdown--;
+
+        int32_t mix = 0;
+        for (uint8_t v = 0; v < voice_count; v++) {
+            voices[v].phase += voices[v].step;
+            mix += synth_wave(voices[v].phase);
+        }
+        buffer[i] = (mix * mix_gain) >> 8;
+    }
+
+    return voice_count > 0 || song_playing;
+}
+
+uint16_t synth_dac_code(int16_t sample, uint16_t max) { return ((uint32_t)(sample + 32768) * max) / 65535; }
@@ -0,0 +1,80 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Fixed-point wavetable synthesizer.
+ *
+ * Every voice is an unsigned 32-bit phase accumulator; one full wrap of the
+ * accumulator is one period of the waveform. Frequencies are converted to
+ * phase increments once, when a note starts, so rendering a sample only costs
+ * integer adds, shifts and a table lookup per active voice. Active voices are
+ * mixed together rather than time-sliced.
+ *
+ * The synthesizer has no hardware dependencies: the platform driver calls
+ * synth_render() whenever it needs more samples (e.g. from a DMA half-buffer
+ * interrupt), and the host tests call it directly to render PCM data.
+ *
+ * The synth_* functions that change state are not reentrant with respect to
+ * synth_render(); callers running in thread context must lock out the
+ * interrupt that renders.
+ */
+
+#ifndef SYNTH_MAX_VOICES
+#    define SYNTH_MAX_VOICES 8
+#endif
+
+// Control-rate updates (glissando, vibrato, song sequencing) happen once every
+// SYNTH_CONTROL_SAMPLES samples, instead of on every sample.
+#ifndef SYNTH_CONTROL_SAMPLES
+#    define SYNTH_CONTROL_SAMPLES 64
+#endif
+
+// Frequencies below this are treated as rests (NOTE_REST is 1.0 on ARM).
+#define SYNTH_MIN_FREQUENCY 30.52f
+
+typedef enum {
+    SYNTH_WAVE_SQUARE = 0,
+    SYNTH_WAVE_TRIANGLE,
+    SYNTH_WAVE_SAWTOOTH,
+    SYNTH_WAVE_SINE,
+} synth_waveform_t;
+
+void     synth_init(uint32_t sample_rate);
+uint32_t synth_sample_rate(void);
+uint32_t synth_increment(float frequency);
+
+bool    synth_voice_start(float frequency);
+void    synth_voice_stop(float frequency);
+void    synth_stop_all(void);
+uint8_t synth_active_voices(void);
+
+void synth_set_waveform(synth_waveform_t waveform);
+void synth_set_duty(uint8_t duty);
+void synth_set_glissando(bool enable);
+void synth_set_vibrato(uint16_t rate, uint8_t depth);
+
+void synth_play_song(float (*notes)[][2], uint16_t count, bool repeat, uint8_t tempo);
+void synth_stop_song(void);
+bool synth_is_playing_song(void);
+
+bool synth_render(int16_t *buffer, uint16_t length);
+
+// Scales a rendered sample to a DAC code from 0 to max, silence being max / 2
+uint16_t synth_dac_code(int16_t sample, uint16_t max);
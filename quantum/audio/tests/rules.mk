@@ -0,0 +1,3 @@
+audio_synth_SRC :=\
+	$(QUANTUM_PATH)/audio/tests/synth_tests.cpp \
+	$(QUANTUM_PATH)/audio/synth.c
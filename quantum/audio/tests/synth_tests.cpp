@@ -0,0 +1,203 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+extern "C" {
+#include "audio/synth.h"
+}
+
+static const uint32_t sample_rate = 22050;
+
+class Synth : public testing::Test {
+   public:
+    Synth() {
+        synth_init(sample_rate);
+        synth_set_waveform(SYNTH_WAVE_SQUARE);
+        synth_set_duty(128);
+        synth_set_glissando(false);
+        synth_set_vibrato(0, 0);
+    }
+
+    std::vector<int16_t> render(uint32_t length) {
+        std::vector<int16_t> samples(length);
+        synth_render(samples.data(), length);
+        return samples;
+    }
+
+    static uint32_t rising_edges(const std::vector<int16_t>& samples) {
+        uint32_t edges = 0;
+        for (size_t i = 1; i < samples.size(); i++) {
+            if (samples[i - 1] < 0 && samples[i] >= 0) {
+                edges++;
+            }
+        }
+        return edges;
+    }
+
+    // Set AUDIO_SYNTH_WAV to a file name to listen to what a test rendered
+    static void write_wav(const std::vector<int16_t>& samples) {
+        const char* path = getenv("AUDIO_SYNTH_WAV");
+        if (!path) {
+            return;
+        }
+        FILE* file = fopen(path, "wb");
+        ASSERT_NE(file, nullptr);
+
+        uint32_t data_size = samples.size() * sizeof(int16_t);
+        uint32_t riff_size = 36 + data_size;
+        uint32_t fmt_size  = 16;
+        uint16_t format    = 1;
+        uint16_t channels  = 1;
+        uint32_t byte_rate = sample_rate * sizeof(int16_t);
+        uint16_t align     = sizeof(int16_t);
+        uint16_t bits      = 16;
+
+        fwrite("RIFF", 1, 4, file);
+        fwrite(&riff_size, 4, 1, file);
+        fwrite("WAVEfmt ", 1, 8, file);
+        fwrite(&fmt_size, 4, 1, file);
+        fwrite(&format, 2, 1, file);
+        fwrite(&channels, 2, 1, file);
+        fwrite(&sample_rate, 4, 1, file);
+        fwrite(&byte_rate, 4, 1, file);
+        fwrite(&align, 2, 1, file);
+        fwrite(&bits, 2, 1, file);
+        fwrite("data", 1, 4, file);
+        fwrite(&data_size, 4, 1, file);
+        fwrite(samples.data(), sizeof(int16_t), samples.size(), file);
+        fclose(file);
+    }
+};
+
+TEST_F(Synth, renders_silence_without_voices) {
+    std::vector<int16_t> samples = render(256);
+    for (int16_t sample : samples) {
+        EXPECT_EQ(sample, 0);
+    }
+}
+
+TEST_F(Synth, scales_samples_to_dac_codes) {
+    // The full range of a 12 bit DAC, with silence in the middle
+    EXPECT_EQ(synth_dac_code(-32768, 4095), 0);
+    EXPECT_EQ(synth_dac_code(0, 4095), 4095 / 2);
+    EXPECT_EQ(synth_dac_code(32767, 4095), 4095);
+    // A lower maximum only turns the volume down
+    EXPECT_EQ(synth_dac_code(0, 2047), 2047 / 2);
+    EXPECT_EQ(synth_dac_code(32767, 2047), 2047);
+
+    // Mixed voices never leave the range of the DAC
+    synth_set_waveform(SYNTH_WAVE_SINE);
+    EXPECT_TRUE(synth_voice_start(440.0f));
+    EXPECT_TRUE(synth_voice_start(554.37f));
+    EXPECT_TRUE(synth_voice_start(659.25f));
+    for (int16_t sample : render(sample_rate / 10)) {
+        EXPECT_LE(synth_dac_code(sample, 4095), 4095);
+    }
+}
+
+TEST_F(Synth, renders_requested_frequency) {
+    EXPECT_TRUE(synth_voice_start(440.0f));
+    std::vector<int16_t> samples = render(sample_rate);
+    EXPECT_NEAR(rising_edges(samples), 440, 1);
+}
+
+TEST_F(Synth, renders_sine_waves) {
+    synth_set_waveform(SYNTH_WAVE_SINE);
+    EXPECT_TRUE(synth_voice_start(1000.0f));
+    std::vector<int16_t> samples = render(sample_rate);
+    EXPECT_NEAR(rising_edges(samples), 1000, 1);
+}
+
+TEST_F(Synth, ignores_rests) {
+    EXPECT_FALSE(synth_voice_start(1.0f));
+    EXPECT_EQ(synth_active_voices(), 0);
+}
+
+TEST_F(Synth, mixes_voices_without_clipping) {
+    for (uint8_t i = 0; i < SYNTH_MAX_VOICES; i++) {
+        EXPECT_TRUE(synth_voice_start(220.0f * (i + 1)));
+    }
+    EXPECT_FALSE(synth_voice_start(110.0f));
+    EXPECT_EQ(synth_active_voices(), SYNTH_MAX_VOICES);
+
+    std::vector<int16_t> samples = render(sample_rate / 10);
+    int16_t              peak    = 0;
+    for (int16_t sample : samples) {
+        peak = std::max<int16_t>(peak, std::abs(sample));
+    }
+    EXPECT_GT(peak, 0);
+    EXPECT_LE(peak, 32767);
+}
+
+TEST_F(Synth, stops_the_matching_voice) {
+    synth_voice_start(440.0f);
+    synth_voice_start(660.0f);
+    synth_voice_stop(440.0f);
+    EXPECT_EQ(synth_active_voices(), 1);
+
+    std::vector<int16_t> samples = render(sample_rate);
+    EXPECT_NEAR(rising_edges(samples), 660, 1);
+
+    synth_voice_stop(660.0f);
+    EXPECT_EQ(synth_active_voices(), 0);
+}
+
+TEST_F(Synth, glides_towards_new_notes) {
+    synth_set_glissando(true);
+    synth_voice_start(440.0f);
+    synth_voice_start(880.0f);
+    synth_voice_stop(440.0f);
+
+    std::vector<int16_t> start = render(sample_rate / 20);
+    std::vector<int16_t> end   = render(sample_rate);
+    EXPECT_LT(rising_edges(start) * 20, 880u);
+    EXPECT_NEAR(rising_edges(end), 880, 2);
+}
+
+TEST_F(Synth, plays_songs_for_their_duration) {
+    static float song[][2] = {{440.0f, 16}, {440.0f, 16}, {880.0f, 16}};
+
+    synth_play_song(&song, 3, false, 100);
+    EXPECT_TRUE(synth_is_playing_song());
+
+    // A quarter note lasts 4 units of 32.768ms at the default tempo, and the
+    // repeated note is separated by a quarter of a unit
+    uint32_t expected = (sample_rate * 3 * 4 * 32768ULL + sample_rate * 32768ULL / 4) / 1000000;
+
+    std::vector<int16_t> samples(expected + sample_rate / 10);
+    uint32_t             rendered = 0;
+    while (rendered < samples.size() && synth_render(&samples[rendered], SYNTH_CONTROL_SAMPLES)) {
+        rendered += SYNTH_CONTROL_SAMPLES;
+    }
+    EXPECT_FALSE(synth_is_playing_song());
+    EXPECT_NEAR(rendered, expected, 2 * SYNTH_CONTROL_SAMPLES);
+
+    samples.resize(rendered);
+    write_wav(samples);
+}
+
+TEST_F(Synth, voices_interrupt_songs) {
+    static float song[][2] = {{440.0f, 16}};
+
+    synth_play_song(&song, 1, true, 100);
+    synth_voice_start(880.0f);
+    EXPECT_FALSE(synth_is_playing_song());
+    EXPECT_EQ(synth_active_voices(), 1);
+}
@@ -17,12 +17,19 @@ static const pin_t backlight_pins[] = BACKLIGHT_PINS;
             pin_t backlight_pin = backlight_pins[i];        \
             { x }                                           \
         }
+
+// Where in the software PWM period each pin is switched on
+static uint8_t backlight_phases[BACKLIGHT_LED_COUNT];
+#    define BACKLIGHT_PHASE backlight_phases[i]
 #else
 // we support only one backlight pin
 static const pin_t backlight_pin = BACKLIGHT_PIN;
 #    define FOR_EACH_LED(x) x
+#    define BACKLIGHT_PHASE 0
 #endif
 
+static uint8_t backlight_period = 1;
+
 static inline void backlight_on(pin_t backlight_pin) {
 #if BACKLIGHT_ON_STATE == 0
     writePinLow(backlight_pin);
@@ -47,3 +54,61 @@ void backlight_pins_init(void) {
 void backlight_pins_on(void) { FOR_EACH_LED(backlight_on(backlight_pin);) }
 
 void backlight_pins_off(void) { FOR_EACH_LED(backlight_off(backlight_pin);) }
+
+void backlight_pins_spread(uint8_t period) {
+    backlight_period = period;
+#if defined(BACKLIGHT_PINS)
+    for (uint8_t i = 0; i < BACKLIGHT_LED_COUNT; i++) {
+        backlight_phases[i] = (uint16_t)i * period / BACKLIGHT_LED_COUNT;
+    }
+#endif
+}
+
+void backlight_pins_pwm(uint8_t tick, uint8_t duty) {
+    FOR_EACH_LED(
+        // Ticks since this pin's period started
+        uint8_t t = tick >= BACKLIGHT_PHASE ? tick - BACKLIGHT_PHASE : tick + backlight_period - BACKLIGHT_PHASE;
+        if (t == duty) {
+            backlight_off(backlight_pin);
+        } else if (t == 0) {
+            backlight_on(backlight_pin);
+        }
+    )
+}
+
+void backlight_pins_pattern(uint8_t tick, uint16_t pattern) {
+    FOR_EACH_LED(
+        uint8_t bit = (tick + BACKLIGHT_PHASE) % backlight_period;
+        if (pattern & ((uint16_t)1 << bit)) {
+            backlight_on(backlight_pin);
+        } else {
+            backlight_off(backlight_pin);
+        }
+    )
+}
+
+// clang-format off
+
+// CIE 1931 lightness, for inputs 0, 1024, 2048 ... 65536
+// See http://jared.geek.nz/2013/feb/linear-led-pwm
+static const uint16_t cie_lightness_table[] PROGMEM = {
+        0,   113,   227,   340,   454,   567,   686,   821,
+      972,  1141,  1328,  1535,  1762,  2010,  2281,  2575,
+     2894,  3237,  3607,  4004,  4429,  4883,  5367,  5882,
+     6429,  7009,  7623,  8272,  8956,  9677, 10436, 11234,
+    12071, 12949, 13868, 14830, 15835, 16885, 17980, 19122,
+    20311, 21548, 22834, 24171, 25558, 26998, 28491, 30038,
+    31640, 33298, 35013, 36786, 38618, 40509, 42461, 44475,
+    46552, 48692, 50897, 53168, 55505, 57909, 60382, 62925,
+    65535
+};
+
+// clang-format on
+
+uint16_t cie_lightness(uint16_t v) {
+    uint8_t  index = v >> 10;
+    uint16_t low   = pgm_read_word(&cie_lightness_table[index]);
+    uint16_t high  = pgm_read_word(&cie_lightness_table[index + 1]);
+    // Straight line between the two nearest entries
+    return low + (uint16_t)(((uint32_t)(high - low) * (v & 0x3FF)) >> 10);
+}
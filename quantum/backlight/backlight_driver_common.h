@@ -1,7 +1,20 @@
 #pragma once
 
+#include <stdint.h>
+
 void backlight_pins_init(void);
 void backlight_pins_on(void);
 void backlight_pins_off(void);
 
+// Software PWM, with the pins spread evenly over the period so that they don't
+// all switch at the same time. A tick goes from 0 to period - 1.
+void backlight_pins_spread(uint8_t period);
+// Each pin is on for the first duty ticks of its period
+void backlight_pins_pwm(uint8_t tick, uint8_t duty);
+// Each pin is on for the ticks whose bit is set, the period is up to 16
+void backlight_pins_pattern(uint8_t tick, uint16_t pattern);
+
+// Perceived brightness to duty cycle, both from 0 to 0xFFFF
+uint16_t cie_lightness(uint16_t v);
+
 void breathing_task(void);
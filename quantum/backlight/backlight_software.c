@@ -6,6 +6,129 @@
 #    error "Backlight breathing is not available for software PWM. Please disable."
 #endif
 
+// The PWM runs from a timer interrupt where there is one that can be used
+// without any setup, otherwise from backlight_task(). ChibiOS has virtual
+// timers, on AVR set BACKLIGHT_SOFTWARE_TIMER to 1 or 3 to use that timer.
+#if defined(PROTOCOL_CHIBIOS) || (defined(__AVR__) && defined(BACKLIGHT_SOFTWARE_TIMER))
+#    define BACKLIGHT_SOFTWARE_ISR
+#endif
+
+#ifdef BACKLIGHT_SOFTWARE_ISR
+
+// The PWM period has to be shorter than this to not flicker
+#    define BACKLIGHT_SOFTWARE_MIN_PWM_FREQUENCY 100
+
+#    if defined(PROTOCOL_CHIBIOS)
+// A virtual timer fires on a system tick, at the earliest CH_CFG_ST_TIMEDELTA ticks later in tick-less mode
+#        if CH_CFG_ST_TIMEDELTA > 0
+#            define BACKLIGHT_SOFTWARE_MAX_FREQUENCY (CH_CFG_ST_FREQUENCY / CH_CFG_ST_TIMEDELTA)
+#        else
+#            define BACKLIGHT_SOFTWARE_MAX_FREQUENCY CH_CFG_ST_FREQUENCY
+#        endif
+#    endif
+
+// Define these in config.h
+#    ifndef BACKLIGHT_SOFTWARE_STEPS
+// How many ticks a PWM period has, up to 255. Fewer when the system tick can't keep up with 64.
+#        if defined(BACKLIGHT_SOFTWARE_MAX_FREQUENCY) && BACKLIGHT_SOFTWARE_MAX_FREQUENCY < 64 * 200
+#            define BACKLIGHT_SOFTWARE_STEPS (BACKLIGHT_SOFTWARE_MAX_FREQUENCY / 200)
+#        else
+#            define BACKLIGHT_SOFTWARE_STEPS 64
+#        endif
+#    endif
+#    ifndef BACKLIGHT_SOFTWARE_FREQUENCY
+// How many ticks there are per second
+#        define BACKLIGHT_SOFTWARE_FREQUENCY (BACKLIGHT_SOFTWARE_STEPS * 200)
+#    endif
+
+#    if BACKLIGHT_SOFTWARE_STEPS < 2
+#        error "BACKLIGHT_SOFTWARE_STEPS has to be at least 2, on ChibiOS the system tick may be too slow, raise CH_CFG_ST_FREQUENCY"
+#    endif
+#    if BACKLIGHT_SOFTWARE_FREQUENCY / BACKLIGHT_SOFTWARE_STEPS < BACKLIGHT_SOFTWARE_MIN_PWM_FREQUENCY
+#        error "The backlight would flicker, BACKLIGHT_SOFTWARE_FREQUENCY has to be at least 100 times BACKLIGHT_SOFTWARE_STEPS"
+#    endif
+#    if defined(PROTOCOL_CHIBIOS) && BACKLIGHT_SOFTWARE_FREQUENCY > BACKLIGHT_SOFTWARE_MAX_FREQUENCY
+#        error "BACKLIGHT_SOFTWARE_FREQUENCY is faster than the system tick, lower it or raise CH_CFG_ST_FREQUENCY"
+#    endif
+
+static volatile uint8_t s_duty = 0;
+static uint8_t          s_tick = 0;
+
+static inline void backlight_tick(void) {
+    uint8_t tick = s_tick;
+    backlight_pins_pwm(tick, s_duty);
+    s_tick = tick + 1 < BACKLIGHT_SOFTWARE_STEPS ? tick + 1 : 0;
+}
+
+#    if defined(PROTOCOL_CHIBIOS)
+
+// The timer is set in whole system ticks, rounding down only makes the PWM faster
+#        define BACKLIGHT_SOFTWARE_PERIOD ((sysinterval_t)(CH_CFG_ST_FREQUENCY / BACKLIGHT_SOFTWARE_FREQUENCY))
+
+static virtual_timer_t backlight_timer;
+
+static void backlight_timer_cb(void *arg) {
+    (void)arg;
+    backlight_tick();
+    osalSysLockFromISR();
+    chVTSetI(&backlight_timer, BACKLIGHT_SOFTWARE_PERIOD, backlight_timer_cb, NULL);
+    osalSysUnlockFromISR();
+}
+
+static void backlight_timer_init(void) {
+    chVTObjectInit(&backlight_timer);
+    chVTSet(&backlight_timer, BACKLIGHT_SOFTWARE_PERIOD, backlight_timer_cb, NULL);
+}
+
+#    elif BACKLIGHT_SOFTWARE_TIMER == 1
+
+ISR(TIMER1_COMPA_vect) { backlight_tick(); }
+
+static void backlight_timer_init(void) {
+    // CTC mode, counting to OCR1A at clk/1
+    TCCR1A = 0;
+    TCCR1B = _BV(WGM12) | _BV(CS10);
+    OCR1A  = F_CPU / BACKLIGHT_SOFTWARE_FREQUENCY - 1;
+    TIMSK1 |= _BV(OCIE1A);
+}
+
+#    elif BACKLIGHT_SOFTWARE_TIMER == 3
+
+ISR(TIMER3_COMPA_vect) { backlight_tick(); }
+
+static void backlight_timer_init(void) {
+    // CTC mode, counting to OCR3A at clk/1
+    TCCR3A = 0;
+    TCCR3B = _BV(WGM32) | _BV(CS30);
+    OCR3A  = F_CPU / BACKLIGHT_SOFTWARE_FREQUENCY - 1;
+    TIMSK3 |= _BV(OCIE3A);
+}
+
+#    else
+#        error "BACKLIGHT_SOFTWARE_TIMER has to be 1 or 3"
+#    endif
+
+void backlight_init_ports(void) {
+    backlight_pins_init();
+    backlight_pins_spread(BACKLIGHT_SOFTWARE_STEPS);
+    backlight_timer_init();
+}
+
+void backlight_set(uint8_t level) {
+    if (level > BACKLIGHT_LEVELS) level = BACKLIGHT_LEVELS;
+
+    uint8_t duty = ((uint32_t)cie_lightness(0xFFFF * (uint32_t)level / BACKLIGHT_LEVELS) * BACKLIGHT_SOFTWARE_STEPS + 0x8000) >> 16;
+    // The lowest level should still be on
+    if (level > 0 && duty == 0) {
+        duty = 1;
+    }
+    s_duty = duty;
+}
+
+void backlight_task(void) {}
+
+#else
+
 static uint16_t s_duty_pattern = 0;
 
 // clang-format off
@@ -32,17 +155,18 @@ static const uint16_t backlight_duty_table[] = {
 
 static uint8_t scale_backlight(uint8_t v) { return v * (backlight_duty_table_size - 1) / BACKLIGHT_LEVELS; }
 
-void backlight_init_ports(void) { backlight_pins_init(); }
+void backlight_init_ports(void) {
+    backlight_pins_init();
+    backlight_pins_spread(16);
+}
 
 void backlight_set(uint8_t level) { s_duty_pattern = backlight_duty_table[scale_backlight(level)]; }
 
 void backlight_task(void) {
     static uint8_t backlight_tick = 0;
 
-    if (s_duty_pattern & ((uint16_t)1 << backlight_tick)) {
-        backlight_pins_on();
-    } else {
-        backlight_pins_off();
-    }
+    backlight_pins_pattern(backlight_tick, s_duty_pattern);
     backlight_tick = (backlight_tick + 1) % 16;
 }
+
+#endif
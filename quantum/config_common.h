@@ -283,6 +283,106 @@
 #        define F14 PAL_LINE(GPIOF, 14)
 #        define F15 PAL_LINE(GPIOF, 15)
 #    endif
+
+#elif defined(PROTOCOL_SIMULATOR)
+// The simulator only needs the names to exist, the pins don't do anything
+#    define PINDEF(port, pin) (((port) << 4) | (pin))
+#    define A0 PINDEF(0, 0)
+#    define A1 PINDEF(0, 1)
+#    define A2 PINDEF(0, 2)
+#    define A3 PINDEF(0, 3)
+#    define A4 PINDEF(0, 4)
+#    define A5 PINDEF(0, 5)
+#    define A6 PINDEF(0, 6)
+#    define A7 PINDEF(0, 7)
+#    define A8 PINDEF(0, 8)
+#    define A9 PINDEF(0, 9)
+#    define A10 PINDEF(0, 10)
+#    define A11 PINDEF(0, 11)
+#    define A12 PINDEF(0, 12)
+#    define A13 PINDEF(0, 13)
+#    define A14 PINDEF(0, 14)
+#    define A15 PINDEF(0, 15)
+#    define B0 PINDEF(1, 0)
+#    define B1 PINDEF(1, 1)
+#    define B2 PINDEF(1, 2)
+#    define B3 PINDEF(1, 3)
+#    define B4 PINDEF(1, 4)
+#    define B5 PINDEF(1, 5)
+#    define B6 PINDEF(1, 6)
+#    define B7 PINDEF(1, 7)
+#    define B8 PINDEF(1, 8)
+#    define B9 PINDEF(1, 9)
+#    define B10 PINDEF(1, 10)
+#    define B11 PINDEF(1, 11)
+#    define B12 PINDEF(1, 12)
+#    define B13 PINDEF(1, 13)
+#    define B14 PINDEF(1, 14)
+#    define B15 PINDEF(1, 15)
+#    define C0 PINDEF(2, 0)
+#    define C1 PINDEF(2, 1)
+#    define C2 PINDEF(2, 2)
+#    define C3 PINDEF(2, 3)
+#    define C4 PINDEF(2, 4)
+#    define C5 PINDEF(2, 5)
+#    define C6 PINDEF(2, 6)
+#    define C7 PINDEF(2, 7)
+#    define C8 PINDEF(2, 8)
+#    define C9 PINDEF(2, 9)
+#    define C10 PINDEF(2, 10)
+#    define C11 PINDEF(2, 11)
+#    define C12 PINDEF(2, 12)
+#    define C13 PINDEF(2, 13)
+#    define C14 PINDEF(2, 14)
+#    define C15 PINDEF(2, 15)
+#    define D0 PINDEF(3, 0)
+#    define D1 PINDEF(3, 1)
+#    define D2 PINDEF(3, 2)
+#    define D3 PINDEF(3, 3)
+#    define D4 PINDEF(3, 4)
+#    define D5 PINDEF(3, 5)
+#    define D6 PINDEF(3, 6)
+#    define D7 PINDEF(3, 7)
+#    define D8 PINDEF(3, 8)
+#    define D9 PINDEF(3, 9)
+#    define D10 PINDEF(3, 10)
+#    define D11 PINDEF(3, 11)
+#    define D12 PINDEF(3, 12)
+#    define D13 PINDEF(3, 13)
+#    define D14 PINDEF(3, 14)
+#    define D15 PINDEF(3, 15)
+#    define E0 PINDEF(4, 0)
+#    define E1 PINDEF(4, 1)
+#    define E2 PINDEF(4, 2)
+#    define E3 PINDEF(4, 3)
+#    define E4 PINDEF(4, 4)
+#    define E5 PINDEF(4, 5)
+#    define E6 PINDEF(4, 6)
+#    define E7 PINDEF(4, 7)
+#    define E8 PINDEF(4, 8)
+#    define E9 PINDEF(4, 9)
+#    define E10 PINDEF(4, 10)
+#    define E11 PINDEF(4, 11)
+#    define E12 PINDEF(4, 12)
+#    define E13 PINDEF(4, 13)
+#    define E14 PINDEF(4, 14)
+#    define E15 PINDEF(4, 15)
+#    define F0 PINDEF(5, 0)
+#    define F1 PINDEF(5, 1)
+#    define F2 PINDEF(5, 2)
+#    define F3 PINDEF(5, 3)
+#    define F4 PINDEF(5, 4)
+#    define F5 PINDEF(5, 5)
+#    define F6 PINDEF(5, 6)
+#    define F7 PINDEF(5, 7)
+#    define F8 PINDEF(5, 8)
+#    define F9 PINDEF(5, 9)
+#    define F10 PINDEF(5, 10)
+#    define F11 PINDEF(5, 11)
+#    define F12 PINDEF(5, 12)
+#    define F13 PINDEF(5, 13)
+#    define F14 PINDEF(5, 14)
+#    define F15 PINDEF(5, 15)
 #endif
 
 /* USART configuration */
@@ -60,5 +60,5 @@ void dip_switch_read(bool forced) {
     if (has_dip_state_changed) {
         dip_switch_update_mask_kb(dip_switch_mask);
     }
-    memcpy(last_dip_switch_state, dip_switch_state, sizeof(&dip_switch_state));
+    memcpy(last_dip_switch_state, dip_switch_state, sizeof(dip_switch_state));
 }
@@ -140,6 +140,36 @@ uint16_t keymap_key_to_keycode(uint8_t layer, keypos_t key) {
     }
 }
 
+// Offsets of the macros in the buffer. They are found in a single pass over
+// the buffer the first time a macro is sent after it has changed, so sending
+// the last macro doesn't mean reading all of the ones before it every time.
+static uint16_t macro_offsets[DYNAMIC_KEYMAP_MACRO_COUNT];
+static uint8_t  macro_offsets_count;
+static bool     macro_offsets_valid = false;
+
+static void dynamic_keymap_macro_build_index(void) {
+    macro_offsets_count = 0;
+    macro_offsets_valid = true;
+
+    // Check the last byte of the buffer.
+    // If it's not zero, then we are in the middle
+    // of buffer writing, possibly an aborted buffer
+    // write. So there are no macros to send.
+    if (eeprom_read_byte((void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE - 1)) != 0) {
+        return;
+    }
+
+    // Each macro starts after the null that ends the one before. If the
+    // buffer doesn't contain DYNAMIC_KEYMAP_MACRO_COUNT nulls, the contents
+    // past the last one are garbage and the later macros are left out.
+    macro_offsets[macro_offsets_count++] = 0;
+    for (uint16_t offset = 0; offset < DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE - 1 && macro_offsets_count < DYNAMIC_KEYMAP_MACRO_COUNT; offset++) {
+        if (eeprom_read_byte((void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + offset)) == 0) {
+            macro_offsets[macro_offsets_count++] = offset + 1;
+        }
+    }
+}
+
 uint8_t dynamic_keymap_macro_get_count(void) { return DYNAMIC_KEYMAP_MACRO_COUNT; }
 
 uint16_t dynamic_keymap_macro_get_buffer_size(void) { return DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE; }
@@ -168,6 +198,7 @@ void dynamic_keymap_macro_set_buffer(uint16_t offset, uint16_t size, uint8_t *da
         source++;
         target++;
     }
+    macro_offsets_valid = false;
 }
 
 void dynamic_keymap_macro_reset(void) {
@@ -177,6 +208,7 @@ void dynamic_keymap_macro_reset(void) {
         eeprom_update_byte(p, 0);
         ++p;
     }
+    macro_offsets_valid = false;
 }
 
 void dynamic_keymap_macro_send(uint8_t id) {
@@ -184,54 +216,39 @@ void dynamic_keymap_macro_send(uint8_t id) {
         return;
     }
 
-    // Check the last byte of the buffer.
-    // If it's not zero, then we are in the middle
-    // of buffer writing, possibly an aborted buffer
-    // write. So do nothing.
-    void *p = (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE - 1);
-    if (eeprom_read_byte(p) != 0) {
-        return;
+    if (!macro_offsets_valid) {
+        dynamic_keymap_macro_build_index();
     }
-
-    // Skip N null characters
-    // p will then point to the Nth macro
-    p         = (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR);
-    void *end = (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE);
-    while (id > 0) {
-        // If we are past the end of the buffer, then the buffer
-        // contents are garbage, i.e. there were not DYNAMIC_KEYMAP_MACRO_COUNT
-        // nulls in the buffer.
-        if (p == end) {
-            return;
-        }
-        if (eeprom_read_byte(p) == 0) {
-            --id;
-        }
-        ++p;
+    if (id >= macro_offsets_count) {
+        return;
     }
 
-    // Send the macro string one or three chars at a time
-    // by making temporary 1 or 3 char strings
-    char data[4] = {0, 0, 0, 0};
-    // We already checked there was a null at the end of
-    // the buffer, so this cannot go past the end
+    // Play the macro as it is read, instead of copying it
+    // into temporary strings for send_string().
+    // The index is only built when there is a null at the end
+    // of the buffer, so this cannot go past the end
+    void *p = (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + macro_offsets[id]);
     while (1) {
-        data[0] = eeprom_read_byte(p++);
-        data[1] = 0;
+        uint8_t data = eeprom_read_byte(p++);
         // Stop at the null terminator of this macro string
-        if (data[0] == 0) {
+        if (data == 0) {
             break;
         }
         // If the char is magic (tap, down, up),
-        // add the next char (key to use) and send a 3 char string.
-        if (data[0] == SS_TAP_CODE || data[0] == SS_DOWN_CODE || data[0] == SS_UP_CODE) {
-            data[1] = data[0];
-            data[0] = SS_QMK_PREFIX;
-            data[2] = eeprom_read_byte(p++);
-            if (data[2] == 0) {
+        // the next char is the key to use
+        if (data == SS_TAP_CODE || data == SS_DOWN_CODE || data == SS_UP_CODE) {
+            uint8_t keycode = eeprom_read_byte(p++);
+            if (keycode == 0) {
                 break;
             }
+            if (data != SS_UP_CODE) {
+                register_code(keycode);
+            }
+            if (data != SS_DOWN_CODE) {
+                unregister_code(keycode);
+            }
+        } else {
+            send_char(data);
         }
-        send_string(data);
     }
 }
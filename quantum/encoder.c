@@ -42,24 +42,66 @@ static pin_t encoders_pad_b[] = ENCODERS_PAD_B;
 #    define ENCODER_CLOCKWISE false
 #    define ENCODER_COUNTER_CLOCKWISE true
 #endif
+
+// Velocity decays to 0 once an encoder hasn't moved for this long (ms)
+#ifndef ENCODER_VELOCITY_TIMEOUT
+#    define ENCODER_VELOCITY_TIMEOUT 200
+#endif
+
+#ifdef ENCODER_INTERRUPT_ENABLE
+#    ifndef PROTOCOL_CHIBIOS
+#        error "ENCODER_INTERRUPT_ENABLE is only supported on ChibiOS"
+#    endif
+// Pulses are counted by the pin change interrupts, and collected at scan time
+#    define ENCODER_LOCK() chSysLock()
+#    define ENCODER_UNLOCK() chSysUnlock()
+#else
+#    define ENCODER_LOCK()
+#    define ENCODER_UNLOCK()
+#endif
+
 static int8_t encoder_LUT[] = {0, -1, 1, 0, 1, 0, 0, -1, -1, 0, 0, 1, 0, 1, -1, 0};
 
-static uint8_t encoder_state[NUMBER_OF_ENCODERS]  = {0};
-static int8_t  encoder_pulses[NUMBER_OF_ENCODERS] = {0};
+static uint8_t          encoder_state[NUMBER_OF_ENCODERS]  = {0};
+static volatile int16_t encoder_pulses[NUMBER_OF_ENCODERS] = {0};
 
 #ifdef SPLIT_KEYBOARD
 // right half encoders come over as second set of encoders
-static uint8_t encoder_value[NUMBER_OF_ENCODERS * 2] = {0};
+#    define NUMBER_OF_ENCODER_VALUES (NUMBER_OF_ENCODERS * 2)
 // row offsets for each hand
 static uint8_t thisHand, thatHand;
 #else
-static uint8_t encoder_value[NUMBER_OF_ENCODERS] = {0};
+#    define NUMBER_OF_ENCODER_VALUES NUMBER_OF_ENCODERS
 #endif
+static uint8_t encoder_value[NUMBER_OF_ENCODER_VALUES] = {0};
+
+// Detents per second, smoothed over consecutive updates
+static uint16_t encoder_velocity[NUMBER_OF_ENCODER_VALUES]   = {0};
+static uint16_t encoder_last_move[NUMBER_OF_ENCODER_VALUES]  = {0};
+static int8_t   encoder_last_steps[NUMBER_OF_ENCODER_VALUES] = {0};
 
 __attribute__((weak)) void encoder_update_user(int8_t index, bool clockwise) {}
 
 __attribute__((weak)) void encoder_update_kb(int8_t index, bool clockwise) { encoder_update_user(index, clockwise); }
 
+__attribute__((weak)) bool encoder_steps_user(int8_t index, int8_t steps) { return true; }
+
+__attribute__((weak)) bool encoder_steps_kb(int8_t index, int8_t steps) { return encoder_steps_user(index, steps); }
+
+static void encoder_sample(uint8_t i) {
+    encoder_state[i] <<= 2;
+    encoder_state[i] |= (readPin(encoders_pad_a[i]) << 0) | (readPin(encoders_pad_b[i]) << 1);
+    encoder_pulses[i] += encoder_LUT[encoder_state[i] & 0xF];
+}
+
+#ifdef ENCODER_INTERRUPT_ENABLE
+static void encoder_pin_cb(void *arg) {
+    chSysLockFromISR();
+    encoder_sample((uintptr_t)arg);
+    chSysUnlockFromISR();
+}
+#endif
+
 void encoder_init(void) {
 #if defined(SPLIT_KEYBOARD) && defined(ENCODERS_PAD_A_RIGHT) && defined(ENCODERS_PAD_B_RIGHT)
     if (!isLeftHand) {
@@ -77,6 +119,14 @@ void encoder_init(void) {
         setPinInputHigh(encoders_pad_b[i]);
 
         encoder_state[i] = (readPin(encoders_pad_a[i]) << 0) | (readPin(encoders_pad_b[i]) << 1);
+
+#ifdef ENCODER_INTERRUPT_ENABLE
+        // Needs PAL_USE_CALLBACKS, and each pad on a different EXTI line (pin number)
+        palSetLineCallback(encoders_pad_a[i], encoder_pin_cb, (void *)(uintptr_t)i);
+        palSetLineCallback(encoders_pad_b[i], encoder_pin_cb, (void *)(uintptr_t)i);
+        palEnableLineEvent(encoders_pad_a[i], PAL_EVENT_MODE_BOTH_EDGES);
+        palEnableLineEvent(encoders_pad_b[i], PAL_EVENT_MODE_BOTH_EDGES);
+#endif
     }
 
 #ifdef SPLIT_KEYBOARD
@@ -85,31 +135,64 @@ void encoder_init(void) {
 #endif
 }
 
-static void encoder_update(int8_t index, uint8_t state) {
-    uint8_t i = index;
-#ifdef SPLIT_KEYBOARD
-    index += thisHand;
-#endif
-    encoder_pulses[i] += encoder_LUT[state & 0xF];
-    if (encoder_pulses[i] >= ENCODER_RESOLUTION) {
-        encoder_value[index]++;
-        encoder_update_kb(index, ENCODER_COUNTER_CLOCKWISE);
+static void encoder_update_velocity(uint8_t index, int8_t steps) {
+    uint16_t elapsed = timer_elapsed(encoder_last_move[index]);
+    uint16_t count   = abs(steps);
+
+    encoder_last_move[index] = timer_read();
+    if (elapsed >= ENCODER_VELOCITY_TIMEOUT || (steps > 0) != (encoder_last_steps[index] > 0)) {
+        // Starting to turn, or changing direction
+        encoder_velocity[index] = (uint32_t)count * 1000 / ENCODER_VELOCITY_TIMEOUT;
+    } else {
+        uint32_t velocity = ((uint32_t)count * 1000 / (elapsed ? elapsed : 1) + encoder_velocity[index]) / 2;
+        encoder_velocity[index] = velocity > UINT16_MAX ? UINT16_MAX : velocity;
+    }
+    encoder_last_steps[index] = steps;
+}
+
+// delta is in encoder_value units, positive is counter-clockwise before ENCODER_DIRECTION_FLIP
+static void encoder_update(uint8_t index, int8_t delta) {
+    encoder_value[index] += delta;
+
+    int8_t steps = ENCODER_CLOCKWISE ? -delta : delta;
+    encoder_update_velocity(index, steps);
+    if (!encoder_steps_kb(index, steps)) {
+        return;
     }
-    if (encoder_pulses[i] <= -ENCODER_RESOLUTION) {  // direction is arbitrary here, but this clockwise
-        encoder_value[index]--;
-        encoder_update_kb(index, ENCODER_CLOCKWISE);
+
+    bool clockwise = steps > 0;
+    for (uint8_t i = abs(steps); i > 0; i--) {
+        encoder_update_kb(index, clockwise);
     }
-    encoder_pulses[i] %= ENCODER_RESOLUTION;
 }
 
 void encoder_read(void) {
     for (uint8_t i = 0; i < NUMBER_OF_ENCODERS; i++) {
-        encoder_state[i] <<= 2;
-        encoder_state[i] |= (readPin(encoders_pad_a[i]) << 0) | (readPin(encoders_pad_b[i]) << 1);
-        encoder_update(i, encoder_state[i]);
+#ifndef ENCODER_INTERRUPT_ENABLE
+        encoder_sample(i);
+#endif
+        ENCODER_LOCK();
+        int8_t delta = encoder_pulses[i] / ENCODER_RESOLUTION;
+        encoder_pulses[i] -= delta * ENCODER_RESOLUTION;
+        ENCODER_UNLOCK();
+
+        if (delta != 0) {
+#ifdef SPLIT_KEYBOARD
+            encoder_update(i + thisHand, delta);
+#else
+            encoder_update(i, delta);
+#endif
+        }
     }
 }
 
+uint16_t encoder_get_velocity(int8_t index) {
+    if (timer_elapsed(encoder_last_move[index]) >= ENCODER_VELOCITY_TIMEOUT) {
+        return 0;
+    }
+    return encoder_velocity[index];
+}
+
 #ifdef SPLIT_KEYBOARD
 void encoder_state_raw(uint8_t* slave_state) { memcpy(slave_state, &encoder_value[thisHand], sizeof(uint8_t) * NUMBER_OF_ENCODERS); }
 
@@ -117,15 +200,8 @@ void encoder_update_raw(uint8_t* slave_state) {
     for (uint8_t i = 0; i < NUMBER_OF_ENCODERS; i++) {
         uint8_t index = i + thatHand;
         int8_t  delta = slave_state[i] - encoder_value[index];
-        while (delta > 0) {
-            delta--;
-            encoder_value[index]++;
-            encoder_update_kb(index, ENCODER_COUNTER_CLOCKWISE);
-        }
-        while (delta < 0) {
-            delta++;
-            encoder_value[index]--;
-            encoder_update_kb(index, ENCODER_CLOCKWISE);
+        if (delta != 0) {
+            encoder_update(index, delta);
         }
     }
 }
@@ -25,6 +25,14 @@ void encoder_read(void);
 void encoder_update_kb(int8_t index, bool clockwise);
 void encoder_update_user(int8_t index, bool clockwise);
 
+// Called with all the detents an encoder turned since the last scan, steps > 0
+// is clockwise. Return false to skip the per-detent encoder_update_* calls.
+bool encoder_steps_kb(int8_t index, int8_t steps);
+bool encoder_steps_user(int8_t index, int8_t steps);
+
+// Turning speed in detents per second, 0 once the encoder has stopped
+uint16_t encoder_get_velocity(int8_t index);
+
 #ifdef SPLIT_KEYBOARD
 void encoder_state_raw(uint8_t* slave_state);
 void encoder_update_raw(uint8_t* slave_state);
@@ -43,4 +43,12 @@ typedef union {
 
 extern keymap_config_t keymap_config;
 
+/* Whether keycode_config() can change any keycode, i.e. whether anything
+ * other than NKRO is set in keymap_config */
+static inline bool keymap_config_has_swaps(void) {
+    keymap_config_t swaps = keymap_config;
+    swaps.nkro            = false;
+    return swaps.raw != 0;
+}
+
 #endif /* KEYCODE_CONFIG_H */
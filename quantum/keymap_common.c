@@ -40,14 +40,100 @@ extern keymap_config_t keymap_config;
 
 #include <inttypes.h>
 
+/*
+ * Keycodes are decoded to actions by first looking up which kind of range they
+ * are in, and then handling each kind in its own way. Above the basic keycodes
+ * all the ranges start and end on a multiple of 256, so the kind is looked up
+ * by the upper byte. Ranges of features that are turned off are still listed,
+ * and decode to ACTION_NO.
+ */
+enum keycode_decoder {
+    DECODE_NO = 0,
+    DECODE_BASIC,
+    DECODE_MODS,
+    DECODE_FUNCTION,
+    DECODE_MACRO,
+    DECODE_LAYER_TAP,
+    DECODE_TO,
+    DECODE_MOMENTARY,
+    DECODE_DEF_LAYER,
+    DECODE_TOGGLE_LAYER,
+    DECODE_ONE_SHOT_LAYER,
+    DECODE_ONE_SHOT_MOD,
+    DECODE_LAYER_TAP_TOGGLE,
+    DECODE_LAYER_MOD,
+    DECODE_SWAP_HANDS,
+    DECODE_MOD_TAP,
+};
+
+#define KEYCODE_RANGE(first, last) [(first) >> 8 ... (last) >> 8]
+
+// Everything above QK_MOD_TAP_MAX decodes to ACTION_NO, so the table stops there
+static const uint8_t PROGMEM keycode_decoders[(QK_MOD_TAP_MAX >> 8) + 1] = {
+    KEYCODE_RANGE(QK_BASIC, QK_BASIC_MAX)                       = DECODE_BASIC,
+    KEYCODE_RANGE(QK_MODS, QK_MODS_MAX)                         = DECODE_MODS,
+    KEYCODE_RANGE(QK_FUNCTION, QK_FUNCTION_MAX)                 = DECODE_FUNCTION,
+    KEYCODE_RANGE(QK_MACRO, QK_MACRO_MAX)                       = DECODE_MACRO,
+    KEYCODE_RANGE(QK_LAYER_TAP, QK_LAYER_TAP_MAX)               = DECODE_LAYER_TAP,
+    KEYCODE_RANGE(QK_TO, QK_TO_MAX)                             = DECODE_TO,
+    KEYCODE_RANGE(QK_MOMENTARY, QK_MOMENTARY_MAX)               = DECODE_MOMENTARY,
+    KEYCODE_RANGE(QK_DEF_LAYER, QK_DEF_LAYER_MAX)               = DECODE_DEF_LAYER,
+    KEYCODE_RANGE(QK_TOGGLE_LAYER, QK_TOGGLE_LAYER_MAX)         = DECODE_TOGGLE_LAYER,
+    KEYCODE_RANGE(QK_ONE_SHOT_LAYER, QK_ONE_SHOT_LAYER_MAX)     = DECODE_ONE_SHOT_LAYER,
+    KEYCODE_RANGE(QK_ONE_SHOT_MOD, QK_ONE_SHOT_MOD_MAX)         = DECODE_ONE_SHOT_MOD,
+    KEYCODE_RANGE(QK_LAYER_TAP_TOGGLE, QK_LAYER_TAP_TOGGLE_MAX) = DECODE_LAYER_TAP_TOGGLE,
+    KEYCODE_RANGE(QK_LAYER_MOD, QK_LAYER_MOD_MAX)               = DECODE_LAYER_MOD,
+#ifdef SWAP_HANDS_ENABLE
+    KEYCODE_RANGE(QK_SWAP_HANDS, QK_SWAP_HANDS_MAX)             = DECODE_SWAP_HANDS,
+#endif
+    KEYCODE_RANGE(QK_MOD_TAP, QK_MOD_TAP_MAX)                   = DECODE_MOD_TAP,
+};
+
+static uint8_t keycode_decoder(uint16_t keycode) {
+    if (keycode > QK_MOD_TAP_MAX) {
+        return DECODE_NO;
+    }
+    return pgm_read_byte(&keycode_decoders[keycode >> 8]);
+}
+
+/* converts a basic keycode to action, the rest are done by action_for_key() */
+static uint16_t basic_keycode_to_action(uint16_t keycode) {
+    // The most common ones first
+    if (keycode >= KC_A && keycode <= KC_EXSEL) {
+        return ACTION_KEY(keycode);
+    }
+    if (keycode >= KC_LCTRL && keycode <= KC_RGUI) {
+        return ACTION_KEY(keycode);
+    }
+#ifdef EXTRAKEY_ENABLE
+    if (keycode >= KC_SYSTEM_POWER && keycode <= KC_SYSTEM_WAKE) {
+        return ACTION_USAGE_SYSTEM(KEYCODE2SYSTEM(keycode));
+    }
+    if (keycode >= KC_AUDIO_MUTE && keycode <= KC_BRIGHTNESS_DOWN) {
+        return ACTION_USAGE_CONSUMER(KEYCODE2CONSUMER(keycode));
+    }
+#endif
+#ifdef MOUSEKEY_ENABLE
+    if (keycode >= KC_MS_UP && keycode <= KC_MS_ACCEL2) {
+        return ACTION_MOUSEKEY(keycode);
+    }
+#endif
+#ifndef NO_ACTION_FUNCTION
+    if (keycode >= KC_FN0 && keycode <= KC_FN31) {
+        return keymap_function_id_to_action(FN_INDEX(keycode));
+    }
+#endif
+    if (keycode == KC_TRNS) {
+        return ACTION_TRANSPARENT;
+    }
+    return ACTION_NO;
+}
+
 /* converts key to action */
 action_t action_for_key(uint8_t layer, keypos_t key) {
     // 16bit keycodes - important
     uint16_t keycode = keymap_key_to_keycode(layer, key);
 
-    // keycode remapping
-    keycode = keycode_config(keycode);
-
     action_t action = {};
     uint8_t  action_layer, when, mod;
 
@@ -55,44 +141,40 @@ action_t action_for_key(uint8_t layer, keypos_t key) {
     (void)when;
     (void)mod;
 
-    switch (keycode) {
-        case KC_A ... KC_EXSEL:
-        case KC_LCTRL ... KC_RGUI:
-            action.code = ACTION_KEY(keycode);
-            break;
-#ifdef EXTRAKEY_ENABLE
-        case KC_SYSTEM_POWER ... KC_SYSTEM_WAKE:
-            action.code = ACTION_USAGE_SYSTEM(KEYCODE2SYSTEM(keycode));
-            break;
-        case KC_AUDIO_MUTE ... KC_BRIGHTNESS_DOWN:
-            action.code = ACTION_USAGE_CONSUMER(KEYCODE2CONSUMER(keycode));
-            break;
-#endif
-#ifdef MOUSEKEY_ENABLE
-        case KC_MS_UP ... KC_MS_ACCEL2:
-            action.code = ACTION_MOUSEKEY(keycode);
-            break;
-#endif
-        case KC_TRNS:
-            action.code = ACTION_TRANSPARENT;
+    // Most of the keys on upper layers are one of these, and
+    // layer_switch_get_layer() looks them up on every active layer
+    if (keycode == KC_TRNS) {
+        action.code = ACTION_TRANSPARENT;
+        return action;
+    }
+    if (keycode == KC_NO) {
+        action.code = ACTION_NO;
+        return action;
+    }
+
+    // keycode remapping, only needed while something is swapped
+    if (keymap_config_has_swaps()) {
+        keycode = keycode_config(keycode);
+    }
+
+    switch (keycode_decoder(keycode)) {
+        case DECODE_BASIC:
+            action.code = basic_keycode_to_action(keycode);
             break;
-        case QK_MODS ... QK_MODS_MAX:;
+        case DECODE_MODS:
             // Has a modifier
             // Split it up
             action.code = ACTION_MODS_KEY(keycode >> 8, keycode & 0xFF);  // adds modifier to key
             break;
 #ifndef NO_ACTION_FUNCTION
-        case KC_FN0 ... KC_FN31:
-            action.code = keymap_function_id_to_action(FN_INDEX(keycode));
-            break;
-        case QK_FUNCTION ... QK_FUNCTION_MAX:;
+        case DECODE_FUNCTION:
             // Is a shortcut for function action_layer, pull last 12bits
             // This means we have 4,096 FN macros at our disposal
             action.code = keymap_function_id_to_action((int)keycode & 0xFFF);
             break;
 #endif
 #ifndef NO_ACTION_MACRO
-        case QK_MACRO ... QK_MACRO_MAX:
+        case DECODE_MACRO:
             if (keycode & 0x800)  // tap macros have upper bit set
                 action.code = ACTION_MACRO_TAP(keycode & 0xFF);
             else
@@ -100,61 +182,61 @@ action_t action_for_key(uint8_t layer, keypos_t key) {
             break;
 #endif
 #ifndef NO_ACTION_LAYER
-        case QK_LAYER_TAP ... QK_LAYER_TAP_MAX:
+        case DECODE_LAYER_TAP:
             action.code = ACTION_LAYER_TAP_KEY((keycode >> 0x8) & 0xF, keycode & 0xFF);
             break;
-        case QK_TO ... QK_TO_MAX:;
+        case DECODE_TO:
             // Layer set "GOTO"
             when         = (keycode >> 0x4) & 0x3;
             action_layer = keycode & 0xF;
             action.code  = ACTION_LAYER_SET(action_layer, when);
             break;
-        case QK_MOMENTARY ... QK_MOMENTARY_MAX:;
+        case DECODE_MOMENTARY:
             // Momentary action_layer
             action_layer = keycode & 0xFF;
             action.code  = ACTION_LAYER_MOMENTARY(action_layer);
             break;
-        case QK_DEF_LAYER ... QK_DEF_LAYER_MAX:;
+        case DECODE_DEF_LAYER:
             // Set default action_layer
             action_layer = keycode & 0xFF;
             action.code  = ACTION_DEFAULT_LAYER_SET(action_layer);
             break;
-        case QK_TOGGLE_LAYER ... QK_TOGGLE_LAYER_MAX:;
+        case DECODE_TOGGLE_LAYER:
             // Set toggle
             action_layer = keycode & 0xFF;
             action.code  = ACTION_LAYER_TOGGLE(action_layer);
             break;
 #endif
 #ifndef NO_ACTION_ONESHOT
-        case QK_ONE_SHOT_LAYER ... QK_ONE_SHOT_LAYER_MAX:;
+        case DECODE_ONE_SHOT_LAYER:
             // OSL(action_layer) - One-shot action_layer
             action_layer = keycode & 0xFF;
             action.code  = ACTION_LAYER_ONESHOT(action_layer);
             break;
-        case QK_ONE_SHOT_MOD ... QK_ONE_SHOT_MOD_MAX:;
+        case DECODE_ONE_SHOT_MOD:
             // OSM(mod) - One-shot mod
             mod         = mod_config(keycode & 0xFF);
             action.code = ACTION_MODS_ONESHOT(mod);
             break;
 #endif
 #ifndef NO_ACTION_LAYER
-        case QK_LAYER_TAP_TOGGLE ... QK_LAYER_TAP_TOGGLE_MAX:
+        case DECODE_LAYER_TAP_TOGGLE:
             action.code = ACTION_LAYER_TAP_TOGGLE(keycode & 0xFF);
             break;
-        case QK_LAYER_MOD ... QK_LAYER_MOD_MAX:
+        case DECODE_LAYER_MOD:
             mod          = mod_config(keycode & 0xF);
             action_layer = (keycode >> 4) & 0xF;
             action.code  = ACTION_LAYER_MODS(action_layer, mod);
             break;
 #endif
 #ifndef NO_ACTION_TAPPING
-        case QK_MOD_TAP ... QK_MOD_TAP_MAX:
+        case DECODE_MOD_TAP:
             mod         = mod_config((keycode >> 0x8) & 0x1F);
             action.code = ACTION_MODS_TAP_KEY(mod, keycode & 0xFF);
             break;
 #endif
 #ifdef SWAP_HANDS_ENABLE
-        case QK_SWAP_HANDS ... QK_SWAP_HANDS_MAX:
+        case DECODE_SWAP_HANDS:
             action.code = ACTION(ACT_SWAP_HANDS, keycode & 0xff);
             break;
 #endif
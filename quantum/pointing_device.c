@@ -23,16 +23,63 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "debug.h"
 #include "pointing_device.h"
 
+// Wheel movement passed to pointing_device_scroll() is in 1/POINTING_DEVICE_SCROLL_DIVISOR detents
+#ifndef POINTING_DEVICE_SCROLL_DIVISOR
+#    define POINTING_DEVICE_SCROLL_DIVISOR 1
+#endif
+
 static report_mouse_t mouseReport = {};
 
+// Movement that hasn't been sent yet, including whatever didn't fit into the
+// last report, so fast motion gets to the host over several reports instead of
+// being clipped
+static int16_t pending_x, pending_y, pending_v, pending_h;
+static uint8_t sent_buttons;
+
+static int16_t add_saturated(int16_t a, int16_t b) {
+    int32_t sum = (int32_t)a + b;
+    return sum > INT16_MAX ? INT16_MAX : sum < -INT16_MAX ? -INT16_MAX : sum;
+}
+
+// Takes as much of pending as fits into a report field, in units of divisor
+static int16_t take_pending(int16_t *pending, int16_t divisor, int16_t max) {
+    int16_t value = *pending / divisor;
+    value         = value > max ? max : value < -max ? -max : value;
+    *pending -= value * divisor;
+    return value;
+}
+
 __attribute__((weak)) void pointing_device_init(void) {
     // initialize device, if that needs to be done.
 }
 
+void pointing_device_move(int16_t x, int16_t y) {
+    pending_x = add_saturated(pending_x, x);
+    pending_y = add_saturated(pending_y, y);
+}
+
+void pointing_device_scroll(int16_t v, int16_t h) {
+    pending_v = add_saturated(pending_v, v);
+    pending_h = add_saturated(pending_h, h);
+}
+
 __attribute__((weak)) void pointing_device_send(void) {
-    // If you need to do other things, like debugging, this is the place to do it.
-    host_mouse_send(&mouseReport);
-    // send it and 0 it out except for buttons, so those stay until they are explicity over-ridden using update_pointing_device
+    // Movement set directly in the report is added to what's pending
+    pointing_device_move(mouseReport.x, mouseReport.y);
+    pointing_device_scroll(mouseReport.v * POINTING_DEVICE_SCROLL_DIVISOR, mouseReport.h * POINTING_DEVICE_SCROLL_DIVISOR);
+
+    mouseReport.x = take_pending(&pending_x, 1, MOUSE_XY_REPORT_MAX);
+    mouseReport.y = take_pending(&pending_y, 1, MOUSE_XY_REPORT_MAX);
+    mouseReport.v = take_pending(&pending_v, POINTING_DEVICE_SCROLL_DIVISOR, 127);
+    mouseReport.h = take_pending(&pending_h, POINTING_DEVICE_SCROLL_DIVISOR, 127);
+
+    // Only talk to the host when something changed
+    if (mouseReport.x || mouseReport.y || mouseReport.v || mouseReport.h || mouseReport.buttons != sent_buttons) {
+        // If you need to do other things, like debugging, this is the place to do it.
+        host_mouse_send(&mouseReport);
+        sent_buttons = mouseReport.buttons;
+    }
+    // 0 it out except for buttons, so those stay until they are explicity over-ridden using update_pointing_device
     mouseReport.x = 0;
     mouseReport.y = 0;
     mouseReport.v = 0;
@@ -41,8 +88,11 @@ __attribute__((weak)) void pointing_device_send(void) {
 
 __attribute__((weak)) void pointing_device_task(void) {
     // gather info and put it in:
-    // mouseReport.x = 127 max -127 min
-    // mouseReport.y = 127 max -127 min
+    // pointing_device_move(x, y) for movement, any amount
+    // pointing_device_scroll(v, h) for scrolling, in 1/POINTING_DEVICE_SCROLL_DIVISOR detents
+    // or directly into the report:
+    // mouseReport.x = 127 max -127 min (32767 with MOUSE_EXTENDED_REPORT)
+    // mouseReport.y = 127 max -127 min (32767 with MOUSE_EXTENDED_REPORT)
     // mouseReport.v = 127 max -127 min (scroll vertical)
     // mouseReport.h = 127 max -127 min (scroll horizontal)
     // mouseReport.buttons = 0x1F (decimal 31, binary 00011111) max (bitmask for mouse buttons 1-5, 1 is rightmost, 5 is leftmost) 0x00 min
@@ -52,4 +102,4 @@ __attribute__((weak)) void pointing_device_task(void) {
 
 report_mouse_t pointing_device_get_report(void) { return mouseReport; }
 
-void pointing_device_set_report(report_mouse_t newMouseReport) { mouseReport = newMouseReport; }
\ No newline at end of file
+void pointing_device_set_report(report_mouse_t newMouseReport) { mouseReport = newMouseReport; }
@@ -27,5 +27,7 @@ void           pointing_device_task(void);
 void           pointing_device_send(void);
 report_mouse_t pointing_device_get_report(void);
 void           pointing_device_set_report(report_mouse_t newMouseReport);
+void           pointing_device_move(int16_t x, int16_t y);
+void           pointing_device_scroll(int16_t v, int16_t h);
 
 #endif
@@ -58,11 +58,23 @@
 #define GEMINI_STATE_SIZE 6
 #define MAX_STATE_SIZE GEMINI_STATE_SIZE
 
+// Room for a chord and the bolt terminating byte
+#define MAX_PACKET_SIZE (MAX_STATE_SIZE + 1)
+
 static uint8_t      state[MAX_STATE_SIZE] = {0};
 static uint8_t      chord[MAX_STATE_SIZE] = {0};
 static int8_t       pressed               = 0;
 static steno_mode_t mode;
 
+#ifdef VIRTSER_ENABLE
+// Chords waiting to be sent, so that all of them go out in one write
+static uint8_t  tx_buffer[STENO_CHORD_BUFFER_SIZE * MAX_PACKET_SIZE];
+static uint8_t  tx_length = 0;
+static uint16_t tx_time;  // when the first chord in the buffer was completed
+#endif
+static uint16_t latency     = 0;
+static uint16_t max_latency = 0;
+
 static const uint8_t boltmap[64] PROGMEM = {TXB_NUL, TXB_NUM, TXB_NUM, TXB_NUM, TXB_NUM, TXB_NUM, TXB_NUM, TXB_S_L, TXB_S_L, TXB_T_L, TXB_K_L, TXB_P_L, TXB_W_L, TXB_H_L, TXB_R_L, TXB_A_L, TXB_O_L, TXB_STR, TXB_STR, TXB_NUL, TXB_NUL, TXB_NUL, TXB_STR, TXB_STR, TXB_E_R, TXB_U_R, TXB_F_R, TXB_R_R, TXB_P_R, TXB_B_R, TXB_L_R, TXB_G_R, TXB_T_R, TXB_S_R, TXB_D_R, TXB_NUM, TXB_NUM, TXB_NUM, TXB_NUM, TXB_NUM, TXB_NUM, TXB_Z_R};
 
 static void steno_clear_state(void) {
@@ -70,16 +82,40 @@ static void steno_clear_state(void) {
     memset(chord, 0, sizeof(chord));
 }
 
+static void steno_send_byte(uint8_t byte) {
+#ifdef VIRTSER_ENABLE
+    tx_buffer[tx_length++] = byte;
+#endif
+}
+
 static void send_steno_state(uint8_t size, bool send_empty) {
     for (uint8_t i = 0; i < size; ++i) {
         if (chord[i] || send_empty) {
-#ifdef VIRTSER_ENABLE
-            virtser_send(chord[i]);
-#endif
+            steno_send_byte(chord[i]);
         }
     }
 }
 
+void steno_task(void) {
+#ifdef VIRTSER_ENABLE
+    if (tx_length == 0) {
+        return;
+    }
+
+    virtser_send_buffer(tx_buffer, tx_length);
+    tx_length = 0;
+
+    latency = timer_elapsed(tx_time);
+    if (latency > max_latency) {
+        max_latency = latency;
+    }
+#endif
+}
+
+uint16_t steno_get_latency(void) { return latency; }
+
+uint16_t steno_get_max_latency(void) { return max_latency; }
+
 void steno_init() {
     if (!eeconfig_is_enabled()) {
         eeconfig_init();
@@ -88,6 +124,8 @@ void steno_init() {
 }
 
 void steno_set_mode(steno_mode_t new_mode) {
+    // chords already completed go out in the protocol they were made in
+    steno_task();
     steno_clear_state();
     mode = new_mode;
     eeprom_update_byte(EECONFIG_STENOMODE, mode);
@@ -102,14 +140,20 @@ __attribute__((weak)) bool postprocess_steno_user(uint16_t keycode, keyrecord_t
 
 __attribute__((weak)) bool process_steno_user(uint16_t keycode, keyrecord_t *record) { return true; }
 
-static void send_steno_chord(void) {
+static void send_steno_chord(uint16_t time) {
     if (send_steno_chord_user(mode, chord)) {
+#ifdef VIRTSER_ENABLE
+        if (sizeof(tx_buffer) - tx_length < MAX_PACKET_SIZE) {
+            steno_task();
+        }
+        if (tx_length == 0) {
+            tx_time = time;
+        }
+#endif
         switch (mode) {
             case STENO_MODE_BOLT:
                 send_steno_state(BOLT_STATE_SIZE, false);
-#ifdef VIRTSER_ENABLE
-                virtser_send(0);  // terminating byte
-#endif
+                steno_send_byte(0);  // terminating byte
                 break;
             case STENO_MODE_GEMINI:
                 chord[0] |= 0x80;  // Indicate start of packet
@@ -187,7 +231,7 @@ bool process_steno(uint16_t keycode, keyrecord_t *record) {
                     --pressed;
                     if (pressed <= 0) {
                         pressed = 0;
-                        send_steno_chord();
+                        send_steno_chord(record->event.time);
                     }
                 }
             }
@@ -18,12 +18,20 @@
 
 #include "quantum.h"
 
+// Number of chords that can be waiting to be sent together
+#ifndef STENO_CHORD_BUFFER_SIZE
+#    define STENO_CHORD_BUFFER_SIZE 4
+#endif
+
 typedef enum { STENO_MODE_BOLT, STENO_MODE_GEMINI } steno_mode_t;
 
 bool     process_steno(uint16_t keycode, keyrecord_t *record);
 void     steno_init(void);
+void     steno_task(void);
 void     steno_set_mode(steno_mode_t mode);
 uint8_t *steno_get_state(void);
 uint8_t *steno_get_chord(void);
+uint16_t steno_get_latency(void);
+uint16_t steno_get_max_latency(void);
 
 #endif
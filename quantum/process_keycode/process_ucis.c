@@ -15,12 +15,118 @@
  */
 
 #include "process_ucis.h"
+#include <string.h>
 
 qk_ucis_state_t qk_ucis_state;
 
+// Number of symbols in ucis_symbol_table, and whether they are sorted, worked out on first use
+static uint16_t table_size   = 0;
+static bool     table_sorted = false;
+
+static void ucis_scan_table(void) {
+    if (table_size) {
+        return;
+    }
+
+    table_sorted = true;
+    while (ucis_symbol_table[table_size].symbol) {
+        if (table_size > 0 && strcmp(ucis_symbol_table[table_size - 1].symbol, ucis_symbol_table[table_size].symbol) >= 0) {
+            table_sorted = false;
+        }
+        table_size++;
+    }
+}
+
+static char ucis_keycode_to_char(uint16_t keycode) {
+    switch (keycode) {
+        case KC_A ... KC_Z:
+            return keycode - KC_A + 'a';
+        case KC_1 ... KC_9:
+            return keycode - KC_1 + '1';
+        case KC_0:
+            return '0';
+        default:
+            return 0;
+    }
+}
+
+/*
+ * Compares the first len characters of symbol with what has been typed, like
+ * strncmp(). A key that isn't a letter or a digit matches nothing, it sorts
+ * after the end of a symbol and before any character, so the comparison
+ * stops at the end of the symbol at the latest.
+ */
+static int ucis_compare(const char *symbol, uint8_t len) {
+    for (uint8_t i = 0; i < len; i++) {
+        char c = ucis_keycode_to_char(qk_ucis_state.codes[i]);
+        if (symbol[i] == '\0') {
+            return -1;
+        }
+        if (c == 0) {
+            return 1;
+        }
+        if (symbol[i] != c) {
+            return (uint8_t)symbol[i] - (uint8_t)c;
+        }
+    }
+    return 0;
+}
+
+// Binary search for the first symbol that sorts after the first len characters typed, or at them unless after is set
+static uint16_t ucis_search(uint8_t len, bool after) {
+    uint16_t lo = 0, hi = table_size;
+    while (lo < hi) {
+        uint16_t mid = lo + (hi - lo) / 2;
+        int      cmp = ucis_compare(ucis_symbol_table[mid].symbol, len);
+        if (cmp < 0 || (after && cmp == 0)) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+/*
+ * Narrows the candidates down to the symbols starting with what has been
+ * typed so far. The table has to be sorted for this, otherwise every symbol
+ * stays a candidate.
+ */
+static void ucis_update_candidates(uint8_t len) {
+    if (!table_sorted) {
+        qk_ucis_state.first      = 0;
+        qk_ucis_state.candidates = table_size;
+        return;
+    }
+
+    qk_ucis_state.first      = ucis_search(len, false);
+    qk_ucis_state.candidates = ucis_search(len, true) - qk_ucis_state.first;
+}
+
+// Returns the index of the symbol matching the first len characters typed, or table_size if there is none
+static uint16_t ucis_find_symbol(uint8_t len) {
+    uint16_t i = 0, end = table_size;
+    if (table_sorted) {
+        // An exact match sorts before anything else it is a prefix of
+        i   = qk_ucis_state.first;
+        end = qk_ucis_state.candidates ? i + 1 : i;
+    }
+
+    for (; i < end; i++) {
+        const char *symbol = ucis_symbol_table[i].symbol;
+        if (ucis_compare(symbol, len) == 0 && symbol[len] == '\0') {
+            return i;
+        }
+    }
+    return table_size;
+}
+
 void qk_ucis_start(void) {
+    ucis_scan_table();
+
     qk_ucis_state.count       = 0;
     qk_ucis_state.in_progress = true;
+    ucis_update_candidates(0);
 
     qk_ucis_start_user();
 }
@@ -33,22 +139,6 @@ __attribute__((weak)) void qk_ucis_start_user(void) {
 
 __attribute__((weak)) void qk_ucis_success(uint8_t symbol_index) {}
 
-static bool is_uni_seq(char *seq) {
-    uint8_t i;
-
-    for (i = 0; seq[i]; i++) {
-        uint16_t code;
-        if (('1' <= seq[i]) && (seq[i] <= '0'))
-            code = seq[i] - '1' + KC_1;
-        else
-            code = seq[i] - 'a' + KC_A;
-
-        if (i > qk_ucis_state.count || qk_ucis_state.codes[i] != code) return false;
-    }
-
-    return (qk_ucis_state.codes[i] == KC_ENT || qk_ucis_state.codes[i] == KC_SPC);
-}
-
 __attribute__((weak)) void qk_ucis_symbol_fallback(void) {
     for (uint8_t i = 0; i < qk_ucis_state.count - 1; i++) {
         uint8_t code = qk_ucis_state.codes[i];
@@ -105,6 +195,7 @@ bool process_ucis(uint16_t keycode, keyrecord_t *record) {
     if (keycode == KC_BSPC) {
         if (qk_ucis_state.count >= 2) {
             qk_ucis_state.count -= 2;
+            ucis_update_candidates(qk_ucis_state.count);
             return true;
         } else {
             qk_ucis_state.count--;
@@ -113,8 +204,6 @@ bool process_ucis(uint16_t keycode, keyrecord_t *record) {
     }
 
     if (keycode == KC_ENT || keycode == KC_SPC || keycode == KC_ESC) {
-        bool symbol_found = false;
-
         for (i = qk_ucis_state.count; i > 0; i--) {
             register_code(KC_BSPC);
             unregister_code(KC_BSPC);
@@ -127,25 +216,31 @@ bool process_ucis(uint16_t keycode, keyrecord_t *record) {
             return false;
         }
 
+        uint16_t symbol_index = ucis_find_symbol(qk_ucis_state.count - 1);
         unicode_input_start();
-        for (i = 0; ucis_symbol_table[i].symbol; i++) {
-            if (is_uni_seq(ucis_symbol_table[i].symbol)) {
-                symbol_found = true;
-                register_ucis(ucis_symbol_table[i].code + 2);
-                break;
-            }
-        }
-        if (!symbol_found) {
+        if (symbol_index < table_size) {
+            register_ucis(ucis_symbol_table[symbol_index].code + 2);
+        } else {
             qk_ucis_symbol_fallback();
         }
         unicode_input_finish();
 
-        if (symbol_found) {
-            qk_ucis_success(i);
+        if (symbol_index < table_size) {
+            qk_ucis_success(symbol_index);
         }
 
         qk_ucis_state.in_progress = false;
         return false;
     }
+
+    ucis_update_candidates(qk_ucis_state.count);
+#ifdef UCIS_REJECT_UNMATCHED
+    if (qk_ucis_state.candidates == 0) {
+        // Nothing starts like this, don't let it be typed
+        qk_ucis_state.count--;
+        ucis_update_candidates(qk_ucis_state.count);
+        return false;
+    }
+#endif
     return true;
 }
@@ -30,8 +30,10 @@ typedef struct {
 
 typedef struct {
     uint8_t  count;
-    uint16_t codes[UCIS_MAX_SYMBOL_LENGTH];
+    uint16_t codes[UCIS_MAX_SYMBOL_LENGTH + 1];  // and the key that ends or edits a full symbol
     bool     in_progress : 1;
+    uint16_t first;       // index of the first symbol starting with what has been typed
+    uint16_t candidates;  // number of symbols starting with what has been typed
 } qk_ucis_state_t;
 
 extern qk_ucis_state_t qk_ucis_state;
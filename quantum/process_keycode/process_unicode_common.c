@@ -16,12 +16,27 @@
 
 #include "process_unicode_common.h"
 #include "eeprom.h"
-#include <ctype.h>
-#include <string.h>
 
 unicode_config_t unicode_config;
 uint8_t          unicode_saved_mods;
 
+// Code points waiting to be typed by unicode_task()
+static uint32_t queue[UNICODE_QUEUE_SIZE];
+static uint8_t  queue_head  = 0;
+static uint8_t  queue_count = 0;
+
+// The code point being typed, as the hex digits to tap
+static enum { UNICODE_IDLE, UNICODE_STARTING, UNICODE_TYPING } typing_state = UNICODE_IDLE;
+static uint8_t  digits[8];
+static uint8_t  digit_count;
+static uint8_t  digit_index;
+static uint16_t typing_timer;
+
+// Set while unicode_task() starts input, so that the default
+// unicode_input_start() leaves the delay to it instead of waiting
+static bool defer_delay   = false;
+static bool delay_pending = false;
+
 #if UNICODE_SELECTED_MODES != -1
 static uint8_t selected[]     = {UNICODE_SELECTED_MODES};
 static uint8_t selected_count = sizeof selected / sizeof *selected;
@@ -94,7 +109,11 @@ __attribute__((weak)) void unicode_input_start(void) {
             break;
     }
 
-    wait_ms(UNICODE_TYPE_DELAY);
+    if (defer_delay) {
+        delay_pending = true;
+    } else {
+        wait_ms(UNICODE_TYPE_DELAY);
+    }
 }
 
 __attribute__((weak)) void unicode_input_finish(void) {
@@ -168,6 +187,121 @@ void register_hex32(uint32_t hex) {
     }
 }
 
+/*
+ * Works out the hex digits to type for code_point in the current input mode.
+ * Returns how many there are, or 0 if the input mode can't type it.
+ */
+static uint8_t render_code_point(uint32_t code_point, uint8_t *out) {
+    uint8_t input_mode = unicode_config.input_mode;
+    uint8_t count      = 0;
+
+    if (code_point > 0x10FFFF || (code_point > 0xFFFF && input_mode == UC_WIN)) {
+        // Character is out of range supported by the platform
+        return 0;
+    }
+
+    if (code_point > 0xFFFF && input_mode == UC_MAC) {
+        // Convert to UTF-16 surrogate pair on Mac
+        code_point -= 0x10000;
+        uint16_t hi = 0xD800 + (code_point >> 10), lo = 0xDC00 + (code_point & 0x3FF);
+        for (int8_t i = 3; i >= 0; i--) {
+            out[count++] = (hi >> (i * 4)) & 0xF;
+        }
+        for (int8_t i = 3; i >= 0; i--) {
+            out[count++] = (lo >> (i * 4)) & 0xF;
+        }
+        return count;
+    }
+
+    // At least four digits, without leading zeros beyond that
+    int8_t i = 3;
+    while (i < 7 && (code_point >> ((i + 1) * 4))) {
+        i++;
+    }
+    for (; i >= 0; i--) {
+        out[count++] = (code_point >> (i * 4)) & 0xF;
+    }
+    return count;
+}
+
+void queue_unicode(uint32_t code_point) {
+    if (queue_count == UNICODE_QUEUE_SIZE) {
+        unicode_flush();
+    }
+
+    queue[(queue_head + queue_count) % UNICODE_QUEUE_SIZE] = code_point;
+    queue_count++;
+}
+
+/*
+ * Types the queued code points, one keystroke per call, so that the scan loop
+ * carries on while they are typed instead of waiting for each one.
+ */
+void unicode_task(void) {
+    switch (typing_state) {
+        case UNICODE_IDLE:
+            if (queue_count == 0) {
+                return;
+            }
+
+            digit_count = render_code_point(queue[queue_head], digits);
+            digit_index = 0;
+            queue_head  = (queue_head + 1) % UNICODE_QUEUE_SIZE;
+            queue_count--;
+
+            defer_delay   = true;
+            delay_pending = false;
+            unicode_input_start();
+            defer_delay = false;
+
+            if (digit_count == 0) {
+                unicode_input_cancel();
+                return;
+            }
+            typing_timer = timer_read();
+            typing_state = UNICODE_STARTING;
+            return;
+
+        case UNICODE_STARTING:
+            if (delay_pending && timer_elapsed(typing_timer) < UNICODE_TYPE_DELAY) {
+                return;
+            }
+            typing_state = UNICODE_TYPING;
+            // fall through
+
+        case UNICODE_TYPING:
+            tap_code(hex_to_keycode(digits[digit_index++]));
+            if (digit_index == digit_count) {
+                unicode_input_finish();
+                typing_state = UNICODE_IDLE;
+            }
+            return;
+    }
+}
+
+// Types everything that is still queued before returning
+void unicode_flush(void) {
+    while (queue_count > 0 || typing_state != UNICODE_IDLE) {
+        if (typing_state == UNICODE_STARTING && delay_pending) {
+            wait_ms(1);
+        }
+        unicode_task();
+    }
+}
+
+bool unicode_is_typing(void) { return queue_count > 0 || typing_state != UNICODE_IDLE; }
+
+static int8_t hex_digit_value(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    } else if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 0xA;
+    } else if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 0xA;
+    }
+    return -1;
+}
+
 void send_unicode_hex_string(const char *str) {
     if (!str) {
         return;
@@ -177,23 +311,20 @@ void send_unicode_hex_string(const char *str) {
         // Find the next code point (token) in the string
         for (; *str == ' '; str++)
             ;
-        size_t n = strcspn(str, " ");  // Length of the current token
-        char   code_point[n + 1];
-        strncpy(code_point, str, n);
-        code_point[n] = '\0';  // Make sure it's null-terminated
-
-        // Normalize the code point: make all hex digits lowercase
-        for (char *p = code_point; *p; p++) {
-            *p = tolower((unsigned char)*p);
+        if (!*str) {
+            break;
         }
 
-        // Send the code point as a Unicode input string
-        unicode_input_start();
-        send_string(code_point);
-        unicode_input_finish();
-
-        str += n;  // Move to the first ' ' (or '\0') after the current token
+        uint32_t code_point = 0;
+        for (; *str && *str != ' '; str++) {
+            int8_t value = hex_digit_value(*str);
+            if (value >= 0) {
+                code_point = (code_point << 4) | value;
+            }
+        }
+        queue_unicode(code_point);
     }
+    unicode_flush();
 }
 
 // Borrowed from https://nullprogram.com/blog/2017/10/06/
@@ -236,11 +367,10 @@ void send_unicode_string(const char *str) {
         str = decode_utf8(str, &code_point);
 
         if (code_point >= 0) {
-            unicode_input_start();
-            register_hex32(code_point);
-            unicode_input_finish();
+            queue_unicode(code_point);
         }
     }
+    unicode_flush();
 }
 
 bool process_unicode_common(uint16_t keycode, keyrecord_t *record) {
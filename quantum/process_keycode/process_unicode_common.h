@@ -49,6 +49,11 @@
 #    define UNICODE_TYPE_DELAY 10
 #endif
 
+// Number of code points that can be waiting to be typed
+#ifndef UNICODE_QUEUE_SIZE
+#    define UNICODE_QUEUE_SIZE 8
+#endif
+
 // Deprecated aliases
 #if !defined(UNICODE_KEY_MAC) && defined(UNICODE_KEY_OSX)
 #    define UNICODE_KEY_MAC UNICODE_KEY_OSX
@@ -92,6 +97,11 @@ void register_hex32(uint32_t hex);
 void send_unicode_hex_string(const char *str);
 void send_unicode_string(const char *str);
 
+void queue_unicode(uint32_t code_point);
+void unicode_task(void);
+void unicode_flush(void);
+bool unicode_is_typing(void);
+
 bool process_unicode_common(uint16_t keycode, keyrecord_t *record);
 
 #define UC_BSPC UC(0x0008)
@@ -38,6 +38,10 @@ extern backlight_config_t backlight_config;
 #    include "process_midi.h"
 #endif
 
+#ifdef EEPROM_DRIVER
+#    include "eeprom_driver.h"
+#endif
+
 #ifdef VELOCIKEY_ENABLE
 #    include "velocikey.h"
 #endif
@@ -144,6 +148,9 @@ void reset_keyboard(void) {
 #endif
 #ifdef HAPTIC_ENABLE
     haptic_shutdown();
+#endif
+#ifdef EEPROM_DRIVER
+    eeprom_driver_flush();
 #endif
     bootloader_jump();
 }
@@ -208,6 +215,11 @@ bool process_record_quantum(keyrecord_t *record) {
     preprocess_tap_dance(keycode, record);
 #endif
 
+#if defined(UNICODE_ENABLE) || defined(UNICODEMAP_ENABLE) || defined(UCIS_ENABLE)
+    // Finish typing queued Unicode first, so that it isn't mixed up with this key
+    unicode_flush();
+#endif
+
     if (!(
 #if defined(KEY_LOCK_ENABLE)
             // Must run first to be able to mask key_up events.
@@ -210,6 +210,21 @@ typedef ioline_t pin_t;
 #    define writePin(pin, level) ((level) ? writePinHigh(pin) : writePinLow(pin))
 
 #    define readPin(pin) palReadLine(pin)
+
+#elif defined(PROTOCOL_SIMULATOR)
+typedef uint8_t pin_t;
+
+// There is nothing behind the pins, inputs read as if they were pulled up
+#    define setPinInput(pin) ((void)(pin))
+#    define setPinInputHigh(pin) ((void)(pin))
+#    define setPinInputLow(pin) ((void)(pin))
+#    define setPinOutput(pin) ((void)(pin))
+
+#    define writePinHigh(pin) ((void)(pin))
+#    define writePinLow(pin) ((void)(pin))
+#    define writePin(pin, level) ((void)(pin), (void)(level))
+
+#    define readPin(pin) ((void)(pin), true)
 #endif
 
 #define SEND_STRING(string) send_string_P(PSTR(string))
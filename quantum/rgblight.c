@@ -41,6 +41,9 @@
 #ifndef MIN
 #    define MIN(a, b) (((a) < (b)) ? (a) : (b))
 #endif
+#ifndef MAX
+#    define MAX(a, b) (((a) > (b)) ? (a) : (b))
+#endif
 
 #ifdef RGBLIGHT_SPLIT
 /* for split keyboard */
@@ -112,10 +115,42 @@ static uint8_t clipping_num_leds  = RGBLED_NUM;
 static uint8_t effect_start_pos   = 0;
 static uint8_t effect_end_pos     = RGBLED_NUM;
 static uint8_t effect_num_leds    = RGBLED_NUM;
+// The part of the effect range that is sent to the LEDs, counted from the
+// start of the effect range. The effects only draw these, so the halves of
+// a split keyboard each draw their own LEDs.
+static uint8_t render_start = 0;
+static uint8_t render_end   = RGBLED_NUM;
+
+#if defined(RGBLIGHT_USE_TIMER) && !defined(RGBLIGHT_NO_FRAME_SKIP) && !defined(RGBLIGHT_CUSTOM_DRIVER)
+#    define RGBLIGHT_FRAME_SKIP
+// What was last sent to the LEDs, in the order it was sent in. Frames of the
+// animations only send the LEDs up to the last one that changed.
+static LED_TYPE led_sent[RGBLED_NUM];
+static bool     led_sent_valid  = false;
+static bool     animation_frame = false;
+#endif
+
+static void rgblight_update_render_range(void) {
+#ifdef RGBLIGHT_LED_MAP
+    // The clipping range is in the order the LEDs are sent in, which isn't
+    // the order of led[]
+    render_start = 0;
+    render_end   = effect_num_leds;
+#else
+    uint8_t start = MAX(clipping_start_pos, effect_start_pos);
+    uint8_t end   = MIN(clipping_start_pos + clipping_num_leds, effect_end_pos);
+    render_start  = start - effect_start_pos;
+    render_end    = end > start ? end - effect_start_pos : render_start;
+#endif
+}
 
 void rgblight_set_clipping_range(uint8_t start_pos, uint8_t num_leds) {
     clipping_start_pos = start_pos;
     clipping_num_leds  = num_leds;
+    rgblight_update_render_range();
+#ifdef RGBLIGHT_FRAME_SKIP
+    led_sent_valid = false;
+#endif
 }
 
 void rgblight_set_effect_range(uint8_t start_pos, uint8_t num_leds) {
@@ -124,6 +159,7 @@ void rgblight_set_effect_range(uint8_t start_pos, uint8_t num_leds) {
     effect_start_pos = start_pos;
     effect_end_pos   = start_pos + num_leds;
     effect_num_leds  = num_leds;
+    rgblight_update_render_range();
 }
 
 void sethsv_raw(uint8_t hue, uint8_t sat, uint8_t val, LED_TYPE *led1) {
@@ -143,6 +179,15 @@ void setrgb(uint8_t r, uint8_t g, uint8_t b, LED_TYPE *led1) {
 #endif
 }
 
+// Converts once and copies the color to count LEDs
+static inline void sethsv_fill(uint8_t hue, uint8_t sat, uint8_t val, LED_TYPE *start, uint8_t count) {
+    LED_TYPE tmp_led;
+    sethsv(hue, sat, val, &tmp_led);
+    for (uint8_t i = 0; i < count; i++) {
+        start[i] = tmp_led;
+    }
+}
+
 void rgblight_check_config(void) {
     /* Add some out of bound checks for RGB light config */
 
@@ -468,7 +513,7 @@ void rgblight_sethsv_eeprom_helper(uint8_t hue, uint8_t sat, uint8_t val, bool w
 #    else
                 uint8_t range = RGBLED_GRADIENT_RANGES[delta / 2];
 #    endif
-                for (uint8_t i = 0; i < effect_num_leds; i++) {
+                for (uint8_t i = render_start; i < render_end; i++) {
                     uint8_t _hue = ((uint16_t)i * (uint16_t)range) / effect_num_leds;
                     if (direction) {
                         _hue = hue + _hue;
@@ -654,9 +699,8 @@ static void rgblight_layers_write(void) {
                 break;  // No more segments
             }
             // Write segment.count LEDs
-            LED_TYPE *const limit = &led[MIN(segment.index + segment.count, RGBLED_NUM)];
-            for (LED_TYPE *led_ptr = &led[segment.index]; led_ptr < limit; led_ptr++) {
-                sethsv(segment.hue, segment.sat, segment.val, led_ptr);
+            if (segment.index < RGBLED_NUM) {
+                sethsv_fill(segment.hue, segment.sat, segment.val, &led[segment.index], MIN(segment.count, RGBLED_NUM - segment.index));
             }
             segment_ptr++;
         }
@@ -665,6 +709,27 @@ static void rgblight_layers_write(void) {
 #endif
 
 #ifndef RGBLIGHT_CUSTOM_DRIVER
+#    ifdef RGBLIGHT_FRAME_SKIP
+// Returns how many LEDs have to be sent, none if the frame is what the LEDs
+// already show. Anything else than an animation frame is sent in full, as
+// the LEDs may have been written to by someone else.
+static uint16_t rgblight_changed_leds(const LED_TYPE *start_led, uint16_t num_leds) {
+    LED_TYPE *sent    = &led_sent[clipping_start_pos];
+    uint16_t  changed = animation_frame && led_sent_valid ? 0 : num_leds;
+
+    for (uint16_t i = 0; i < num_leds; i++) {
+        if (memcmp(&sent[i], &start_led[i], sizeof(LED_TYPE)) != 0) {
+            sent[i] = start_led[i];
+            if (changed <= i) {
+                changed = i + 1;
+            }
+        }
+    }
+    led_sent_valid = true;
+    return changed;
+}
+#    endif
+
 void rgblight_set(void) {
     LED_TYPE *start_led;
     uint16_t  num_leds = clipping_num_leds;
@@ -700,6 +765,12 @@ void rgblight_set(void) {
     for (uint8_t i = 0; i < num_leds; i++) {
         convert_rgb_to_rgbw(&start_led[i]);
     }
+#    endif
+#    ifdef RGBLIGHT_FRAME_SKIP
+    num_leds = rgblight_changed_leds(start_led, num_leds);
+    if (num_leds == 0) {
+        return;
+    }
 #    endif
     ws2812_setleds(start_led, num_leds);
 }
@@ -716,6 +787,8 @@ void rgblight_get_syncinfo(rgblight_syncinfo_t *syncinfo) {
     syncinfo->status = rgblight_status;
 }
 
+bool rgblight_sync_status_only(const rgblight_syncinfo_t *syncinfo) { return (syncinfo->status.change_flags & (RGBLIGHT_STATUS_CHANGE_MODE | RGBLIGHT_STATUS_CHANGE_HSVS)) == 0; }
+
 /* for split keyboard slave side */
 void rgblight_update_sync(rgblight_syncinfo_t *syncinfo, bool write_to_eeprom) {
 #    ifdef RGBLIGHT_LAYERS
@@ -781,7 +854,7 @@ void rgblight_timer_enable(void) {
     if (!is_static_effect(rgblight_config.mode)) {
         rgblight_status.timer_enabled = true;
     }
-    animation_status.last_timer = timer_read();
+    animation_status.next_timer = timer_read32();
     RGBLIGHT_SPLIT_SET_CHANGE_TIMER_ENABLE;
     dprintf("rgblight timer enabled.\n");
 }
@@ -817,100 +890,123 @@ static void rgblight_effect_dummy(animation_status_t *anim) {
     **/
 }
 
-void rgblight_task(void) {
-    if (rgblight_status.timer_enabled) {
-        effect_func_t effect_func   = rgblight_effect_dummy;
-        uint16_t      interval_time = 2000;  // dummy interval
-        uint8_t       delta         = rgblight_config.mode - rgblight_status.base_mode;
-        animation_status.delta      = delta;
+// Picks the effect of the current mode and how long its next frame lasts
+static effect_func_t rgblight_effect_select(uint16_t *interval) {
+    effect_func_t effect_func   = rgblight_effect_dummy;
+    uint16_t      interval_time = 2000;  // dummy interval
+    uint8_t       delta         = rgblight_config.mode - rgblight_status.base_mode;
+    animation_status.delta      = delta;
 
-        // static light mode, do nothing here
-        if (1 == 0) {  // dummy
-        }
+    // static light mode, do nothing here
+    if (1 == 0) {  // dummy
+    }
 #    ifdef RGBLIGHT_EFFECT_BREATHING
-        else if (rgblight_status.base_mode == RGBLIGHT_MODE_BREATHING) {
-            // breathing mode
-            interval_time = get_interval_time(&RGBLED_BREATHING_INTERVALS[delta], 1, 100);
-            effect_func   = rgblight_effect_breathing;
-        }
+    else if (rgblight_status.base_mode == RGBLIGHT_MODE_BREATHING) {
+        // breathing mode
+        interval_time = get_interval_time(&RGBLED_BREATHING_INTERVALS[delta], 1, 100);
+        effect_func   = rgblight_effect_breathing;
+    }
 #    endif
 #    ifdef RGBLIGHT_EFFECT_RAINBOW_MOOD
-        else if (rgblight_status.base_mode == RGBLIGHT_MODE_RAINBOW_MOOD) {
-            // rainbow mood mode
-            interval_time = get_interval_time(&RGBLED_RAINBOW_MOOD_INTERVALS[delta], 5, 100);
-            effect_func   = rgblight_effect_rainbow_mood;
-        }
+    else if (rgblight_status.base_mode == RGBLIGHT_MODE_RAINBOW_MOOD) {
+        // rainbow mood mode
+        interval_time = get_interval_time(&RGBLED_RAINBOW_MOOD_INTERVALS[delta], 5, 100);
+        effect_func   = rgblight_effect_rainbow_mood;
+    }
 #    endif
 #    ifdef RGBLIGHT_EFFECT_RAINBOW_SWIRL
-        else if (rgblight_status.base_mode == RGBLIGHT_MODE_RAINBOW_SWIRL) {
-            // rainbow swirl mode
-            interval_time = get_interval_time(&RGBLED_RAINBOW_SWIRL_INTERVALS[delta / 2], 1, 100);
-            effect_func   = rgblight_effect_rainbow_swirl;
-        }
+    else if (rgblight_status.base_mode == RGBLIGHT_MODE_RAINBOW_SWIRL) {
+        // rainbow swirl mode
+        interval_time = get_interval_time(&RGBLED_RAINBOW_SWIRL_INTERVALS[delta / 2], 1, 100);
+        effect_func   = rgblight_effect_rainbow_swirl;
+    }
 #    endif
 #    ifdef RGBLIGHT_EFFECT_SNAKE
-        else if (rgblight_status.base_mode == RGBLIGHT_MODE_SNAKE) {
-            // snake mode
-            interval_time = get_interval_time(&RGBLED_SNAKE_INTERVALS[delta / 2], 1, 200);
-            effect_func   = rgblight_effect_snake;
-        }
+    else if (rgblight_status.base_mode == RGBLIGHT_MODE_SNAKE) {
+        // snake mode
+        interval_time = get_interval_time(&RGBLED_SNAKE_INTERVALS[delta / 2], 1, 200);
+        effect_func   = rgblight_effect_snake;
+    }
 #    endif
 #    ifdef RGBLIGHT_EFFECT_KNIGHT
-        else if (rgblight_status.base_mode == RGBLIGHT_MODE_KNIGHT) {
-            // knight mode
-            interval_time = get_interval_time(&RGBLED_KNIGHT_INTERVALS[delta], 5, 100);
-            effect_func   = rgblight_effect_knight;
-        }
+    else if (rgblight_status.base_mode == RGBLIGHT_MODE_KNIGHT) {
+        // knight mode
+        interval_time = get_interval_time(&RGBLED_KNIGHT_INTERVALS[delta], 5, 100);
+        effect_func   = rgblight_effect_knight;
+    }
 #    endif
 #    ifdef RGBLIGHT_EFFECT_CHRISTMAS
-        else if (rgblight_status.base_mode == RGBLIGHT_MODE_CHRISTMAS) {
-            // christmas mode
-            interval_time = RGBLIGHT_EFFECT_CHRISTMAS_INTERVAL;
-            effect_func   = (effect_func_t)rgblight_effect_christmas;
-        }
+    else if (rgblight_status.base_mode == RGBLIGHT_MODE_CHRISTMAS) {
+        // christmas mode
+        interval_time = RGBLIGHT_EFFECT_CHRISTMAS_INTERVAL;
+        effect_func   = (effect_func_t)rgblight_effect_christmas;
+    }
 #    endif
 #    ifdef RGBLIGHT_EFFECT_RGB_TEST
-        else if (rgblight_status.base_mode == RGBLIGHT_MODE_RGB_TEST) {
-            // RGB test mode
-            interval_time = pgm_read_word(&RGBLED_RGBTEST_INTERVALS[0]);
-            effect_func   = (effect_func_t)rgblight_effect_rgbtest;
-        }
+    else if (rgblight_status.base_mode == RGBLIGHT_MODE_RGB_TEST) {
+        // RGB test mode
+        interval_time = pgm_read_word(&RGBLED_RGBTEST_INTERVALS[0]);
+        effect_func   = (effect_func_t)rgblight_effect_rgbtest;
+    }
 #    endif
 #    ifdef RGBLIGHT_EFFECT_ALTERNATING
-        else if (rgblight_status.base_mode == RGBLIGHT_MODE_ALTERNATING) {
-            interval_time = 500;
-            effect_func   = (effect_func_t)rgblight_effect_alternating;
-        }
+    else if (rgblight_status.base_mode == RGBLIGHT_MODE_ALTERNATING) {
+        interval_time = 500;
+        effect_func   = (effect_func_t)rgblight_effect_alternating;
+    }
 #    endif
-        if (animation_status.restart) {
-            animation_status.restart    = false;
-            animation_status.last_timer = timer_read() - interval_time - 1;
-            animation_status.pos16      = 0;  // restart signal to local each effect
-        }
-        if (timer_elapsed(animation_status.last_timer) >= interval_time) {
+    *interval = interval_time;
+    return effect_func;
+}
+
+void rgblight_task(void) {
+    if (!rgblight_status.timer_enabled) {
+        return;
+    }
+    uint32_t now = timer_read32();
+    if (animation_status.restart) {
+        animation_status.restart    = false;
+        animation_status.next_timer = now;
+        animation_status.pos16      = 0;  // restart signal to local each effect
+    }
+    // Until the next frame is due there is nothing to do
+    if (!timer_expired32(now, animation_status.next_timer)) {
+        return;
+    }
+
+    uint16_t      interval_time;
+    effect_func_t effect_func = rgblight_effect_select(&interval_time);
 #    if defined(RGBLIGHT_SPLIT) && !defined(RGBLIGHT_SPLIT_NO_ANIMATION_SYNC)
-            static uint16_t report_last_timer = 0;
-            static bool     tick_flag         = false;
-            uint16_t        oldpos16;
-            if (tick_flag) {
-                tick_flag = false;
-                if (timer_elapsed(report_last_timer) >= 30000) {
-                    report_last_timer = timer_read();
-                    dprintf("rgblight animation tick report to slave\n");
-                    RGBLIGHT_SPLIT_ANIMATION_TICK;
-                }
-            }
-            oldpos16 = animation_status.pos16;
+    static uint16_t report_last_timer = 0;
+    static bool     tick_flag         = false;
+    uint16_t        oldpos16;
+    if (tick_flag) {
+        tick_flag = false;
+        if (timer_elapsed(report_last_timer) >= 30000) {
+            report_last_timer = timer_read();
+            dprintf("rgblight animation tick report to slave\n");
+            RGBLIGHT_SPLIT_ANIMATION_TICK;
+        }
+    }
+    oldpos16 = animation_status.pos16;
 #    endif
-            animation_status.last_timer += interval_time;
-            effect_func(&animation_status);
-#    if defined(RGBLIGHT_SPLIT) && !defined(RGBLIGHT_SPLIT_NO_ANIMATION_SYNC)
-            if (animation_status.pos16 == 0 && oldpos16 != 0) {
-                tick_flag = true;
-            }
+    animation_status.next_timer += interval_time;
+    if (timer_expired32(now, animation_status.next_timer)) {
+        // Fell behind, the frames that were missed aren't caught up on
+        animation_status.next_timer = now + interval_time;
+    }
+#    ifdef RGBLIGHT_FRAME_SKIP
+    animation_frame = true;
+    effect_func(&animation_status);
+    animation_frame = false;
+#    else
+    effect_func(&animation_status);
 #    endif
-        }
+#    if defined(RGBLIGHT_SPLIT) && !defined(RGBLIGHT_SPLIT_NO_ANIMATION_SYNC)
+    if (animation_status.pos16 == 0 && oldpos16 != 0) {
+        tick_flag = true;
     }
+#    endif
 }
 
 #endif /* RGBLIGHT_USE_TIMER */
@@ -961,7 +1057,7 @@ void rgblight_effect_rainbow_swirl(animation_status_t *anim) {
     uint8_t hue;
     uint8_t i;
 
-    for (i = 0; i < effect_num_leds; i++) {
+    for (i = render_start; i < render_end; i++) {
         hue = (RGBLIGHT_RAINBOW_SWIRL_RANGE / effect_num_leds * i + anim->current_hue);
         sethsv(hue, rgblight_config.sat, rgblight_config.val, (LED_TYPE *)&led[i + effect_start_pos]);
     }
@@ -999,7 +1095,13 @@ void rgblight_effect_snake(animation_status_t *anim) {
     }
 #    endif
 
-    for (i = 0; i < effect_num_leds; i++) {
+    // Each part of the snake has the same color in every frame
+    LED_TYPE colors[RGBLIGHT_EFFECT_SNAKE_LENGTH];
+    for (j = 0; j < RGBLIGHT_EFFECT_SNAKE_LENGTH; j++) {
+        sethsv(rgblight_config.hue, rgblight_config.sat, (uint8_t)(rgblight_config.val * (RGBLIGHT_EFFECT_SNAKE_LENGTH - j) / RGBLIGHT_EFFECT_SNAKE_LENGTH), &colors[j]);
+    }
+
+    for (i = render_start; i < render_end; i++) {
         LED_TYPE *ledp = led + i + effect_start_pos;
         ledp->r        = 0;
         ledp->g        = 0;
@@ -1016,7 +1118,7 @@ void rgblight_effect_snake(animation_status_t *anim) {
                 k = k + effect_num_leds;
             }
             if (i == k) {
-                sethsv(rgblight_config.hue, rgblight_config.sat, (uint8_t)(rgblight_config.val * (RGBLIGHT_EFFECT_SNAKE_LENGTH - j) / RGBLIGHT_EFFECT_SNAKE_LENGTH), ledp);
+                *ledp = colors[j];
             }
         }
     }
@@ -1069,11 +1171,13 @@ void rgblight_effect_knight(animation_status_t *anim) {
 #    endif
     }
     // Determine which LEDs should be lit up
+    LED_TYPE color;
+    sethsv(rgblight_config.hue, rgblight_config.sat, rgblight_config.val, &color);
     for (i = 0; i < RGBLIGHT_EFFECT_KNIGHT_LED_NUM; i++) {
         cur = (i + RGBLIGHT_EFFECT_KNIGHT_OFFSET) % effect_num_leds + effect_start_pos;
 
         if (i >= low_bound && i <= high_bound) {
-            sethsv(rgblight_config.hue, rgblight_config.sat, rgblight_config.val, (LED_TYPE *)&led[cur]);
+            led[cur] = color;
         } else {
             led[cur].r = 0;
             led[cur].g = 0;
@@ -1106,10 +1210,16 @@ void rgblight_effect_christmas(animation_status_t *anim) {
     uint8_t hue;
     uint8_t i;
 
+    // Red and green
+    LED_TYPE colors[2];
+    for (i = 0; i < 2; i++) {
+        hue = i * 85;
+        sethsv(hue, rgblight_config.sat, rgblight_config.val, &colors[i]);
+    }
+
     anim->current_offset = (anim->current_offset + 1) % 2;
-    for (i = 0; i < effect_num_leds; i++) {
-        hue = 0 + ((i / RGBLIGHT_EFFECT_CHRISTMAS_STEP + anim->current_offset) % 2) * 85;
-        sethsv(hue, rgblight_config.sat, rgblight_config.val, (LED_TYPE *)&led[i + effect_start_pos]);
+    for (i = render_start; i < render_end; i++) {
+        led[i + effect_start_pos] = colors[(i / RGBLIGHT_EFFECT_CHRISTMAS_STEP + anim->current_offset) % 2];
     }
     rgblight_set();
 }
@@ -1148,15 +1258,13 @@ void rgblight_effect_rgbtest(animation_status_t *anim) {
 
 #ifdef RGBLIGHT_EFFECT_ALTERNATING
 void rgblight_effect_alternating(animation_status_t *anim) {
-    for (int i = 0; i < effect_num_leds; i++) {
-        LED_TYPE *ledp = led + i + effect_start_pos;
-        if (i < effect_num_leds / 2 && anim->pos) {
-            sethsv(rgblight_config.hue, rgblight_config.sat, rgblight_config.val, ledp);
-        } else if (i >= effect_num_leds / 2 && !anim->pos) {
-            sethsv(rgblight_config.hue, rgblight_config.sat, rgblight_config.val, ledp);
-        } else {
-            sethsv(rgblight_config.hue, rgblight_config.sat, 0, ledp);
-        }
+    uint8_t half = effect_num_leds / 2;
+    if (anim->pos) {
+        sethsv_fill(rgblight_config.hue, rgblight_config.sat, rgblight_config.val, &led[effect_start_pos], half);
+        sethsv_fill(rgblight_config.hue, rgblight_config.sat, 0, &led[effect_start_pos + half], effect_num_leds - half);
+    } else {
+        sethsv_fill(rgblight_config.hue, rgblight_config.sat, 0, &led[effect_start_pos], half);
+        sethsv_fill(rgblight_config.hue, rgblight_config.sat, rgblight_config.val, &led[effect_start_pos + half], effect_num_leds - half);
     }
     rgblight_set();
     anim->pos = (anim->pos + 1) % 2;
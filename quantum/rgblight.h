@@ -353,6 +353,9 @@ typedef struct _rgblight_syncinfo_t {
 uint8_t rgblight_get_change_flags(void);
 void    rgblight_clear_change_flags(void);
 void    rgblight_get_syncinfo(rgblight_syncinfo_t *syncinfo);
+// True if the slave only needs the status of this syncinfo, and can keep the
+// config it has
+bool rgblight_sync_status_only(const rgblight_syncinfo_t *syncinfo);
 /* for split keyboard slave side */
 void rgblight_update_sync(rgblight_syncinfo_t *syncinfo, bool write_to_eeprom);
 #    endif
@@ -360,7 +363,7 @@ void rgblight_update_sync(rgblight_syncinfo_t *syncinfo, bool write_to_eeprom);
 #    ifdef RGBLIGHT_USE_TIMER
 
 typedef struct _animation_status_t {
-    uint16_t last_timer;
+    uint32_t next_timer; /* when the next frame is due */
     uint8_t  delta; /* mode - base_mode */
     bool     restart;
     union {
@@ -89,6 +89,7 @@ void byte_stuffer_recv_byte(uint8_t link, uint8_t data) {
             } else {
                 // Special case for zeroes
                 state->next_zero               = data;
+                state->long_frame              = data == 0xFF;
                 state->data[state->data_pos++] = 0;
             }
         } else {
@@ -97,39 +98,38 @@ void byte_stuffer_recv_byte(uint8_t link, uint8_t data) {
     }
 }
 
-static void send_block(uint8_t link, uint8_t* start, uint8_t* end, uint8_t num_non_zero) {
-    send_data(link, &num_non_zero, 1);
-    if (end > start) {
-        send_data(link, start, end - start);
-    }
-}
+// Encoded frames are assembled here and handed to the physical layer with a
+// single send_data call. Completed blocks are flushed early when a block of
+// the maximum length would no longer fit, so frames of any size can be sent.
+static uint8_t tx_buffer[BYTE_STUFFER_TX_BUFFER_SIZE];
 
 void byte_stuffer_send_frame(uint8_t link, uint8_t* data, uint16_t size) {
-    const uint8_t zero = 0;
     if (size > 0) {
-        uint16_t num_non_zero = 1;
         uint8_t* end          = data + size;
-        uint8_t* start        = data;
+        uint16_t pos          = 1;
+        uint16_t code_pos     = 0;
+        uint8_t  num_non_zero = 1;
         while (data < end) {
-            if (num_non_zero == 0xFF) {
-                // There's more data after big non-zero block
-                // So send it, and start a new block
-                send_block(link, start, data, num_non_zero);
-                start        = data;
+            if (num_non_zero == 0xFF || *data == 0) {
+                // Close the current block, a full block continues without
+                // consuming any data, while a zero is replaced by the code
+                if (num_non_zero != 0xFF) {
+                    ++data;
+                }
+                tx_buffer[code_pos] = num_non_zero;
+                if (pos > BYTE_STUFFER_TX_BUFFER_SIZE - 0x100) {
+                    send_data(link, tx_buffer, pos);
+                    pos = 0;
+                }
+                code_pos     = pos++;
                 num_non_zero = 1;
             } else {
-                if (*data == 0) {
-                    // A zero encountered, so send the block
-                    send_block(link, start, data, num_non_zero);
-                    start        = data + 1;
-                    num_non_zero = 1;
-                } else {
-                    num_non_zero++;
-                }
-                ++data;
+                tx_buffer[pos++] = *data++;
+                num_non_zero++;
             }
         }
-        send_block(link, start, data, num_non_zero);
-        send_data(link, &zero, 1);
+        tx_buffer[code_pos] = num_non_zero;
+        tx_buffer[pos++]    = 0;
+        send_data(link, tx_buffer, pos);
     }
 }
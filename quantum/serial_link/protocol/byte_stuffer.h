@@ -30,6 +30,11 @@ SOFTWARE.
 #define MAX_FRAME_SIZE 1024
 #define NUM_LINKS 2
 
+// Needs to be at least 0x101 bytes, one maximum length block and the terminator
+#ifndef BYTE_STUFFER_TX_BUFFER_SIZE
+#    define BYTE_STUFFER_TX_BUFFER_SIZE 512
+#endif
+
 void init_byte_stuffer(void);
 void byte_stuffer_recv_byte(uint8_t link, uint8_t data);
 void byte_stuffer_send_frame(uint8_t link, uint8_t* data, uint16_t size);
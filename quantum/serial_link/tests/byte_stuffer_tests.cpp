@@ -26,6 +26,8 @@ SOFTWARE.
 #include "gmock/gmock.h"
 #include <vector>
 #include <algorithm>
+#include <chrono>
+#include <cstdio>
 extern "C" {
 #include "serial_link/protocol/byte_stuffer.h"
 #include "serial_link/protocol/frame_validator.h"
@@ -47,8 +49,12 @@ class ByteStuffer : public ::testing::Test {
 
     MOCK_METHOD3(validator_recv_frame, void(uint8_t link, uint8_t* data, uint16_t size));
 
-    void                 send_data(uint8_t link, const uint8_t* data, uint16_t size) { std::copy(data, data + size, std::back_inserter(sent_data)); }
+    void send_data(uint8_t link, const uint8_t* data, uint16_t size) {
+        std::copy(data, data + size, std::back_inserter(sent_data));
+        send_calls++;
+    }
     std::vector<uint8_t> sent_data;
+    int                  send_calls = 0;
 
     static ByteStuffer* Instance;
 };
@@ -448,3 +454,57 @@ TEST_F(ByteStuffer, sends_and_receives_full_roundtrip_254_bytes_and_then_zero) {
         byte_stuffer_recv_byte(1, d);
     }
 }
+
+TEST_F(ByteStuffer, sends_small_frames_with_a_single_write) {
+    uint8_t data[200];
+    for (int i = 0; i < 200; i++) {
+        data[i] = i % 7 == 0 ? 0 : i;
+    }
+    byte_stuffer_send_frame(0, data, sizeof(data));
+    EXPECT_EQ(send_calls, 1);
+}
+
+TEST_F(ByteStuffer, sends_and_receives_full_roundtrip_frame_larger_than_the_send_buffer) {
+    uint8_t original_data[MAX_FRAME_SIZE];
+    int     i;
+    for (i = 0; i < MAX_FRAME_SIZE; i++) {
+        original_data[i] = i % 300 == 0 ? 0 : i % 251 + 1;
+    }
+    byte_stuffer_send_frame(0, original_data, sizeof(original_data));
+    EXPECT_GT(send_calls, 1);
+    EXPECT_CALL(*this, validator_recv_frame(_, _, _)).With(Args<1, 2>(ElementsAreArray(original_data)));
+    for (auto& d : sent_data) {
+        byte_stuffer_recv_byte(1, d);
+    }
+}
+
+TEST_F(ByteStuffer, benchmark_send_and_receive_throughput) {
+    const int num_frames = 2000;
+    uint8_t   original_data[MAX_FRAME_SIZE];
+    int       i;
+    for (i = 0; i < MAX_FRAME_SIZE; i++) {
+        original_data[i] = i % 100 == 0 ? 0 : i % 251 + 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (i = 0; i < num_frames; i++) {
+        sent_data.clear();
+        byte_stuffer_send_frame(0, original_data, sizeof(original_data));
+    }
+    std::chrono::duration<double> send_elapsed = std::chrono::steady_clock::now() - start;
+
+    EXPECT_CALL(*this, validator_recv_frame(_, _, _)).Times(num_frames);
+    start = std::chrono::steady_clock::now();
+    for (i = 0; i < num_frames; i++) {
+        for (auto& d : sent_data) {
+            byte_stuffer_recv_byte(1, d);
+        }
+    }
+    std::chrono::duration<double> recv_elapsed = std::chrono::steady_clock::now() - start;
+
+    double send_mb_per_s = (double)MAX_FRAME_SIZE * num_frames / send_elapsed.count() / 1e6;
+    double recv_mb_per_s = (double)MAX_FRAME_SIZE * num_frames / recv_elapsed.count() / 1e6;
+    RecordProperty("send_mb_per_s", (int)send_mb_per_s);
+    RecordProperty("recv_mb_per_s", (int)recv_mb_per_s);
+    printf("Byte stuffer throughput: send %.1f MB/s, receive %.1f MB/s\n", send_mb_per_s, recv_mb_per_s);
+}
@@ -24,6 +24,9 @@ SOFTWARE.
 
 #include "gtest/gtest.h"
 #include "gmock/gmock.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
 extern "C" {
 #include "serial_link/protocol/frame_validator.h"
 }
@@ -98,3 +101,51 @@ TEST_F(FrameValidator, sends_five_bytes_with_correct_crc) {
     EXPECT_CALL(*this, byte_stuffer_send_frame(_, _, _)).With(Args<1, 2>(ElementsAreArray(expected)));
     validator_send_frame(0, original, 5);
 }
+
+static uint32_t reference_crc32(const uint8_t* data, uint32_t size) {
+    uint32_t crc = 0xFFFFFFFF;
+    while (size--) {
+        crc ^= *data++;
+        for (int i = 0; i < 8; i++) {
+            crc = (crc >> 1) ^ (crc & 1 ? 0xEDB88320 : 0);
+        }
+    }
+    return crc ^ 0xFFFFFFFF;
+}
+
+TEST_F(FrameValidator, validates_frames_of_all_lengths_and_alignments) {
+    uint8_t data[64 + 4 + 3];
+    for (unsigned i = 0; i < sizeof(data); i++) {
+        data[i] = i * 37 + 11;
+    }
+    EXPECT_CALL(*this, route_incoming_frame(_, _, _)).Times(64 * 4);
+    for (uint16_t size = 1; size <= 64; size++) {
+        for (uint8_t offset = 0; offset < 4; offset++) {
+            uint32_t crc = reference_crc32(data + offset, size);
+            memcpy(data + offset + size, &crc, 4);
+            validator_recv_frame(0, data + offset, size + 4);
+        }
+    }
+}
+
+TEST_F(FrameValidator, benchmark_crc_throughput) {
+    const int frame_size = 1024;
+    const int num_frames = 2000;
+    uint8_t   data[frame_size + 4];
+    for (int i = 0; i < frame_size; i++) {
+        data[i] = i * 13 + 7;
+    }
+    uint32_t crc = reference_crc32(data, frame_size);
+    memcpy(data + frame_size, &crc, 4);
+
+    EXPECT_CALL(*this, route_incoming_frame(_, _, _)).Times(num_frames);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_frames; i++) {
+        validator_recv_frame(0, data, frame_size + 4);
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    double mb_per_s = (double)frame_size * num_frames / elapsed.count() / 1e6;
+    RecordProperty("crc_mb_per_s", (int)mb_per_s);
+    printf("CRC throughput: %.1f MB/s\n", mb_per_s);
+}
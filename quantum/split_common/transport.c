@@ -44,6 +44,7 @@ static I2C_slave_buffer_t *const i2c_buffer = (I2C_slave_buffer_t *)i2c_slave_re
 
 #    define I2C_BACKLIGHT_START offsetof(I2C_slave_buffer_t, backlight_level)
 #    define I2C_RGB_START offsetof(I2C_slave_buffer_t, rgblight_sync)
+#    define I2C_RGB_STATUS_START (I2C_RGB_START + offsetof(rgblight_syncinfo_t, status))
 #    define I2C_KEYMAP_START offsetof(I2C_slave_buffer_t, smatrix)
 #    define I2C_ENCODER_START offsetof(I2C_slave_buffer_t, encoder_state)
 #    define I2C_WPM_START offsetof(I2C_slave_buffer_t, current_wpm)
@@ -72,7 +73,14 @@ bool transport_master(matrix_row_t matrix[]) {
     if (rgblight_get_change_flags()) {
         rgblight_syncinfo_t rgblight_sync;
         rgblight_get_syncinfo(&rgblight_sync);
-        if (i2c_writeReg(SLAVE_I2C_ADDRESS, I2C_RGB_START, (void *)&rgblight_sync, sizeof(rgblight_sync), TIMEOUT) >= 0) {
+        // Unless the config changed, the slave keeps the one it has
+        i2c_status_t status;
+        if (rgblight_sync_status_only(&rgblight_sync)) {
+            status = i2c_writeReg(SLAVE_I2C_ADDRESS, I2C_RGB_STATUS_START, (void *)&rgblight_sync.status, sizeof(rgblight_sync.status), TIMEOUT);
+        } else {
+            status = i2c_writeReg(SLAVE_I2C_ADDRESS, I2C_RGB_START, (void *)&rgblight_sync, sizeof(rgblight_sync), TIMEOUT);
+        }
+        if (status >= 0) {
             rgblight_clear_change_flags();
         }
     }
@@ -162,6 +170,7 @@ typedef struct _Serial_rgblight_t {
 
 volatile Serial_rgblight_t serial_rgblight = {};
 uint8_t volatile status_rgblight           = 0;
+uint8_t volatile status_rgblight_status    = 0;
 #    endif
 
 volatile Serial_s2m_buffer_t serial_s2m_buffer = {};
@@ -172,6 +181,7 @@ enum serial_transaction_id {
     GET_SLAVE_MATRIX = 0,
 #    if defined(RGBLIGHT_ENABLE) && defined(RGBLIGHT_SPLIT)
     PUT_RGBLIGHT,
+    PUT_RGBLIGHT_STATUS,
 #    endif
 };
 
@@ -189,6 +199,11 @@ SSTD_t transactions[] = {
         {
             (uint8_t *)&status_rgblight, sizeof(serial_rgblight), (uint8_t *)&serial_rgblight, 0, NULL  // no slave to master transfer
         },
+    // Only the status part of the same buffer
+    [PUT_RGBLIGHT_STATUS] =
+        {
+            (uint8_t *)&status_rgblight_status, sizeof(serial_rgblight.rgblight_sync.status), (uint8_t *)&serial_rgblight.rgblight_sync.status, 0, NULL  // no slave to master transfer
+        },
 #    endif
 };
 
@@ -203,16 +218,19 @@ void transport_slave_init(void) { soft_serial_target_init(transactions, TID_LIMI
 void transport_rgblight_master(void) {
     if (rgblight_get_change_flags()) {
         rgblight_get_syncinfo((rgblight_syncinfo_t *)&serial_rgblight.rgblight_sync);
-        if (soft_serial_transaction(PUT_RGBLIGHT) == TRANSACTION_END) {
+        // Unless the config changed, the slave keeps the one it has
+        int transaction = rgblight_sync_status_only((rgblight_syncinfo_t *)&serial_rgblight.rgblight_sync) ? PUT_RGBLIGHT_STATUS : PUT_RGBLIGHT;
+        if (soft_serial_transaction(transaction) == TRANSACTION_END) {
             rgblight_clear_change_flags();
         }
     }
 }
 
 void transport_rgblight_slave(void) {
-    if (status_rgblight == TRANSACTION_ACCEPTED) {
+    if (status_rgblight == TRANSACTION_ACCEPTED || status_rgblight_status == TRANSACTION_ACCEPTED) {
         rgblight_update_sync((rgblight_syncinfo_t *)&serial_rgblight.rgblight_sync, false);
-        status_rgblight = TRANSACTION_END;
+        status_rgblight        = TRANSACTION_END;
+        status_rgblight_status = TRANSACTION_END;
     }
 }
 
@@ -0,0 +1,203 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "gtest/gtest.h"
+#include <chrono>
+#include <cstdio>
+extern "C" {
+#include "keymap.h"
+#include "keycode_config.h"
+#include "quantum_keycodes.h"
+}
+
+// The keymap is a single key, whose keycode is set by the tests
+static uint16_t test_keycode;
+
+extern "C" {
+const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {{{KC_NO}}};
+keymap_config_t        keymap_config;
+
+uint16_t keymap_key_to_keycode(uint8_t layer, keypos_t key) { return test_keycode; }
+
+uint16_t keymap_function_id_to_action(uint16_t function_id) { return 0xF000 | function_id; }
+}
+
+// action_for_key() as it was before the keycode ranges were put in a table,
+// everything it returns has to stay the same
+__attribute__((noinline)) static uint16_t reference_action_for_key(uint16_t keycode) {
+    keycode = keycode_config(keycode);
+
+    action_t action = {};
+    uint8_t  action_layer, when, mod;
+
+    switch (keycode) {
+        case KC_A ... KC_EXSEL:
+        case KC_LCTRL ... KC_RGUI:
+            action.code = ACTION_KEY(keycode);
+            break;
+        case KC_SYSTEM_POWER ... KC_SYSTEM_WAKE:
+            action.code = ACTION_USAGE_SYSTEM(KEYCODE2SYSTEM(keycode));
+            break;
+        case KC_AUDIO_MUTE ... KC_BRIGHTNESS_DOWN:
+            action.code = ACTION_USAGE_CONSUMER(KEYCODE2CONSUMER(keycode));
+            break;
+        case KC_MS_UP ... KC_MS_ACCEL2:
+            action.code = ACTION_MOUSEKEY(keycode);
+            break;
+        case KC_TRNS:
+            action.code = ACTION_TRANSPARENT;
+            break;
+        case QK_MODS ... QK_MODS_MAX:
+            action.code = ACTION_MODS_KEY(keycode >> 8, keycode & 0xFF);
+            break;
+        case KC_FN0 ... KC_FN31:
+            action.code = keymap_function_id_to_action(FN_INDEX(keycode));
+            break;
+        case QK_FUNCTION ... QK_FUNCTION_MAX:
+            action.code = keymap_function_id_to_action((int)keycode & 0xFFF);
+            break;
+        case QK_MACRO ... QK_MACRO_MAX:
+            if (keycode & 0x800)
+                action.code = ACTION_MACRO_TAP(keycode & 0xFF);
+            else
+                action.code = ACTION_MACRO(keycode & 0xFF);
+            break;
+        case QK_LAYER_TAP ... QK_LAYER_TAP_MAX:
+            action.code = ACTION_LAYER_TAP_KEY((keycode >> 0x8) & 0xF, keycode & 0xFF);
+            break;
+        case QK_TO ... QK_TO_MAX:
+            when         = (keycode >> 0x4) & 0x3;
+            action_layer = keycode & 0xF;
+            action.code  = ACTION_LAYER_SET(action_layer, when);
+            break;
+        case QK_MOMENTARY ... QK_MOMENTARY_MAX:
+            action.code = ACTION_LAYER_MOMENTARY(keycode & 0xFF);
+            break;
+        case QK_DEF_LAYER ... QK_DEF_LAYER_MAX:
+            action.code = ACTION_DEFAULT_LAYER_SET(keycode & 0xFF);
+            break;
+        case QK_TOGGLE_LAYER ... QK_TOGGLE_LAYER_MAX:
+            action.code = ACTION_LAYER_TOGGLE(keycode & 0xFF);
+            break;
+        case QK_ONE_SHOT_LAYER ... QK_ONE_SHOT_LAYER_MAX:
+            action.code = ACTION_LAYER_ONESHOT(keycode & 0xFF);
+            break;
+        case QK_ONE_SHOT_MOD ... QK_ONE_SHOT_MOD_MAX:
+            mod         = mod_config(keycode & 0xFF);
+            action.code = ACTION_MODS_ONESHOT(mod);
+            break;
+        case QK_LAYER_TAP_TOGGLE ... QK_LAYER_TAP_TOGGLE_MAX:
+            action.code = ACTION_LAYER_TAP_TOGGLE(keycode & 0xFF);
+            break;
+        case QK_LAYER_MOD ... QK_LAYER_MOD_MAX:
+            mod          = mod_config(keycode & 0xF);
+            action_layer = (keycode >> 4) & 0xF;
+            action.code  = ACTION_LAYER_MODS(action_layer, mod);
+            break;
+        case QK_MOD_TAP ... QK_MOD_TAP_MAX:
+            mod         = mod_config((keycode >> 0x8) & 0x1F);
+            action.code = ACTION_MODS_TAP_KEY(mod, keycode & 0xFF);
+            break;
+        case QK_SWAP_HANDS ... QK_SWAP_HANDS_MAX:
+            action.code = ACTION(ACT_SWAP_HANDS, keycode & 0xff);
+            break;
+        default:
+            action.code = ACTION_NO;
+            break;
+    }
+    return action.code;
+}
+
+static uint16_t lookup(uint16_t keycode) {
+    test_keycode = keycode;
+    return action_for_key(0, (keypos_t){.col = 0, .row = 0}).code;
+}
+
+class KeymapCommon : public ::testing::Test {
+   protected:
+    void SetUp() override { keymap_config.raw = 0; }
+
+    void ExpectSameAsReference(void) {
+        for (uint32_t keycode = 0; keycode <= 0xFFFF; keycode++) {
+            EXPECT_EQ(lookup(keycode), reference_action_for_key(keycode));
+        }
+    }
+};
+
+TEST_F(KeymapCommon, AllKeycodesWithoutSwaps) { ExpectSameAsReference(); }
+
+TEST_F(KeymapCommon, AllKeycodesWithNkro) {
+    keymap_config.nkro = true;
+    EXPECT_FALSE(keymap_config_has_swaps());
+    ExpectSameAsReference();
+}
+
+TEST_F(KeymapCommon, AllKeycodesWithCapsLockSwapped) {
+    keymap_config.swap_control_capslock = true;
+    EXPECT_TRUE(keymap_config_has_swaps());
+    ExpectSameAsReference();
+}
+
+TEST_F(KeymapCommon, AllKeycodesWithModifiersSwapped) {
+    keymap_config.swap_lalt_lgui = true;
+    keymap_config.swap_ralt_rgui = true;
+    keymap_config.swap_lctl_lgui = true;
+    keymap_config.swap_rctl_rgui = true;
+    ExpectSameAsReference();
+}
+
+TEST_F(KeymapCommon, AllKeycodesWithEverythingSet) {
+    keymap_config.raw = 0xFFFF;
+    ExpectSameAsReference();
+}
+
+// Not a pass or fail, prints how long a lookup takes compared to the old code
+TEST_F(KeymapCommon, Benchmark) {
+    const int rounds = 20;
+    uint32_t  sum    = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < rounds; round++) {
+        for (uint32_t keycode = 0; keycode <= 0xFFFF; keycode++) {
+            sum += reference_action_for_key(keycode);
+        }
+    }
+    auto middle = std::chrono::steady_clock::now();
+    for (int round = 0; round < rounds; round++) {
+        for (uint32_t keycode = 0; keycode <= 0xFFFF; keycode++) {
+            sum -= lookup(keycode);
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    EXPECT_EQ(sum, 0);
+    printf("action_for_key: %.1f ns per keycode, was %.1f ns\n", std::chrono::duration<double, std::nano>(end - middle).count() / (rounds * 0x10000), std::chrono::duration<double, std::nano>(middle - start).count() / (rounds * 0x10000));
+
+    // Upper layers are mostly KC_TRNS, and each of them is looked up for every key event
+    start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < rounds * 0x10000; i++) {
+        sum += reference_action_for_key(KC_TRNS);
+    }
+    middle = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < rounds * 0x10000; i++) {
+        sum -= lookup(KC_TRNS);
+    }
+    end = std::chrono::steady_clock::now();
+
+    EXPECT_EQ(sum, 0);
+    printf("action_for_key: %.1f ns for KC_TRNS, was %.1f ns\n", std::chrono::duration<double, std::nano>(end - middle).count() / (rounds * 0x10000), std::chrono::duration<double, std::nano>(middle - start).count() / (rounds * 0x10000));
+}
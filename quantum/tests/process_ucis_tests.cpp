@@ -0,0 +1,118 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include <vector>
+extern "C" {
+#include "process_ucis.h"
+}
+
+static std::vector<int> successes;
+static int              fallbacks;
+
+extern "C" {
+// Sorted, with symbols that are prefixes of others
+const qk_ucis_symbol_t ucis_symbol_table[] = UCIS_TABLE(UCIS_SYM("a", 0x61), UCIS_SYM("ab", 0x62), UCIS_SYM("b", 0x63), UCIS_SYM("poop", 0x1F4A9));
+
+void register_code(uint8_t code) {}
+void unregister_code(uint8_t code) {}
+void wait_ms(uint32_t ms) {}
+void unicode_input_start(void) {}
+void unicode_input_finish(void) {}
+void register_hex(uint16_t hex) {}
+
+void qk_ucis_start_user(void) {}
+void qk_ucis_success(uint8_t symbol_index) { successes.push_back(symbol_index); }
+void qk_ucis_symbol_fallback(void) { fallbacks++; }
+}
+
+class ProcessUcis : public testing::Test {
+   public:
+    ProcessUcis() {
+        successes.clear();
+        fallbacks = 0;
+        qk_ucis_start();
+    }
+
+    void tap(uint16_t keycode) {
+        keyrecord_t record = {};
+        record.event.pressed = true;
+        process_ucis(keycode, &record);
+        record.event.pressed = false;
+        process_ucis(keycode, &record);
+    }
+
+    void type(std::vector<uint16_t> keycodes) {
+        for (uint16_t keycode : keycodes) {
+            tap(keycode);
+        }
+    }
+};
+
+TEST_F(ProcessUcis, finds_symbol) {
+    type({KC_A, KC_B});
+    EXPECT_EQ(qk_ucis_state.candidates, 1);
+    tap(KC_ENT);
+    EXPECT_EQ(successes, std::vector<int>({1}));
+    EXPECT_EQ(fallbacks, 0);
+    EXPECT_FALSE(qk_ucis_state.in_progress);
+}
+
+TEST_F(ProcessUcis, finds_symbol_that_is_a_prefix) {
+    type({KC_A});
+    EXPECT_EQ(qk_ucis_state.candidates, 2);
+    tap(KC_ENT);
+    EXPECT_EQ(successes, std::vector<int>({0}));
+}
+
+TEST_F(ProcessUcis, falls_back_on_unknown_symbol) {
+    type({KC_P, KC_O, KC_O});
+    EXPECT_EQ(qk_ucis_state.candidates, 1);
+    tap(KC_ENT);
+    EXPECT_TRUE(successes.empty());
+    EXPECT_EQ(fallbacks, 1);
+}
+
+// Keys that aren't letters or digits match nothing, not even the end of a symbol
+TEST_F(ProcessUcis, does_not_match_other_keys) {
+    type({KC_A, KC_MINUS});
+    EXPECT_EQ(qk_ucis_state.candidates, 0);
+    tap(KC_ENT);
+    EXPECT_TRUE(successes.empty());
+    EXPECT_EQ(fallbacks, 1);
+}
+
+TEST_F(ProcessUcis, does_not_match_other_keys_past_a_symbol) {
+    type({KC_B, KC_DOT, KC_COMMA});
+    EXPECT_EQ(qk_ucis_state.candidates, 0);
+    tap(KC_ENT);
+    EXPECT_TRUE(successes.empty());
+    EXPECT_EQ(fallbacks, 1);
+}
+
+TEST_F(ProcessUcis, does_not_match_other_keys_in_a_symbol) {
+    type({KC_P, KC_O, KC_SLASH, KC_P});
+    EXPECT_EQ(qk_ucis_state.candidates, 0);
+    tap(KC_ENT);
+    EXPECT_TRUE(successes.empty());
+
+    // Backspace takes it out again
+    qk_ucis_start();
+    type({KC_P, KC_O, KC_SLASH, KC_BSPC, KC_O, KC_P});
+    EXPECT_EQ(qk_ucis_state.candidates, 1);
+    tap(KC_ENT);
+    EXPECT_EQ(successes, std::vector<int>({3}));
+}
@@ -0,0 +1,17 @@
+keymap_common_SRC :=\
+	$(QUANTUM_PATH)/tests/keymap_common_tests.cpp \
+	$(QUANTUM_PATH)/keymap_common.c \
+	$(QUANTUM_PATH)/keycode_config.c
+
+# A keymap with a single key, whose keycode is set by the tests
+keymap_common_CONFIG := $(QUANTUM_PATH)/tests/config.h
+
+keymap_common_DEFS := -DNO_PRINT -DNO_DEBUG -DEXTRAKEY_ENABLE -DMOUSEKEY_ENABLE -DSWAP_HANDS_ENABLE
+
+process_ucis_SRC :=\
+	$(QUANTUM_PATH)/tests/process_ucis_tests.cpp \
+	$(QUANTUM_PATH)/process_keycode/process_ucis.c
+
+process_ucis_CONFIG := $(QUANTUM_PATH)/tests/config.h
+
+process_ucis_DEFS := -DNO_PRINT -DNO_DEBUG -DUCIS_ENABLE
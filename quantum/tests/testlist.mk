@@ -0,0 +1,3 @@
+TEST_LIST +=\
+	keymap_common \
+	process_ucis
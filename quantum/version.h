@@ -0,0 +1,4 @@
+#define QMK_VERSION "b59b12"
+#define QMK_BUILDDATE "2026-10-19-17:11:13"
+#define CHIBIOS_VERSION "b59b12"
+#define CHIBIOS_CONTRIB_VERSION "b59b12"
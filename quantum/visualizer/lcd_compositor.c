@@ -0,0 +1,198 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "lcd_compositor.h"
+#include <stddef.h>
+#include <string.h>
+
+lcd_compositor_t* lcd_compositor = NULL;
+
+typedef struct {
+    const void* key;
+    uint32_t    tag;
+    int16_t     x;
+    int16_t     y;
+    uint8_t     width;
+    uint8_t     pages;
+    uint16_t    offset;
+} lcd_strip_t;
+
+static uint8_t     strip_data[LCD_STRIP_CACHE_SIZE];
+static lcd_strip_t strips[LCD_STRIP_CACHE_ENTRIES];
+static uint16_t    strip_data_end = 0;
+static uint8_t     next_strip     = 0;
+
+void lcd_damage_clear(lcd_damage_t* damage) {
+    memset(damage->first, 0xFF, sizeof(damage->first));
+    memset(damage->last, 0, sizeof(damage->last));
+}
+
+void lcd_damage_add(lcd_damage_t* damage, uint8_t page, uint8_t first, uint8_t last) {
+    if (first < damage->first[page]) {
+        damage->first[page] = first;
+    }
+    if (last > damage->last[page]) {
+        damage->last[page] = last;
+    }
+}
+
+void lcd_compositor_init(lcd_compositor_t* compositor, uint8_t* frame, uint8_t* shown, uint8_t width, uint8_t height, uint8_t buffers) {
+    uint16_t frame_size = width * (height / 8);
+
+    compositor->frame   = frame;
+    compositor->width   = width;
+    compositor->pages   = height / 8;
+    compositor->buffers = buffers;
+    compositor->back    = 0;
+    for (uint8_t i = 0; i < buffers; i++) {
+        // Whatever the display shows at first is unknown, so everything is
+        // pushed the first time
+        compositor->shown[i]       = shown + i * frame_size;
+        compositor->shown_valid[i] = false;
+        lcd_damage_clear(&compositor->damage[i]);
+    }
+}
+
+void lcd_compositor_damage(lcd_compositor_t* compositor, int x, int y, int cx, int cy) {
+    int last_x = x + cx;
+    int last_y = y + cy;
+    if (x < 0) {
+        x = 0;
+    }
+    if (y < 0) {
+        y = 0;
+    }
+    if (last_x > compositor->width) {
+        last_x = compositor->width;
+    }
+    if (last_y > compositor->pages * 8) {
+        last_y = compositor->pages * 8;
+    }
+    if (x >= last_x || y >= last_y) {
+        return;
+    }
+
+    for (uint8_t page = y / 8; page <= (last_y - 1) / 8; page++) {
+        for (uint8_t i = 0; i < compositor->buffers; i++) {
+            lcd_damage_add(&compositor->damage[i], page, x, last_x);
+        }
+    }
+}
+
+uint16_t lcd_compositor_push(lcd_compositor_t* compositor, lcd_push_func push, void* context) {
+    uint8_t       back   = compositor->back;
+    uint8_t*      shown  = compositor->shown[back];
+    lcd_damage_t* damage = &compositor->damage[back];
+    uint16_t      pushed = 0;
+
+    for (uint8_t page = 0; page < compositor->pages; page++) {
+        uint16_t offset = page * compositor->width;
+        uint8_t  first  = damage->first[page];
+        uint8_t  last   = damage->last[page];
+        // Only the bytes between the first and the last change are pushed,
+        // every push of a span costs setting the column address
+        if (compositor->shown_valid[back]) {
+            while (first < last && compositor->frame[offset + first] == shown[offset + first]) {
+                first++;
+            }
+            while (last > first && compositor->frame[offset + last - 1] == shown[offset + last - 1]) {
+                last--;
+            }
+        }
+        if (first < last) {
+            push(context, page, first, &compositor->frame[offset + first], last - first);
+            memcpy(&shown[offset + first], &compositor->frame[offset + first], last - first);
+            pushed += last - first;
+        }
+    }
+
+    lcd_damage_clear(damage);
+    compositor->shown_valid[back] = true;
+    if (compositor->buffers > 1) {
+        compositor->back = !back;
+    }
+    return pushed;
+}
+
+static lcd_strip_t* find_strip(const void* key, int x, int y) {
+    for (uint8_t i = 0; i < LCD_STRIP_CACHE_ENTRIES; i++) {
+        if (strips[i].key == key && strips[i].x == x && strips[i].y == y) {
+            return &strips[i];
+        }
+    }
+    return NULL;
+}
+
+void lcd_strip_save(lcd_compositor_t* compositor, const void* key, uint32_t tag, int x, int y, int cx, int cy) {
+    if (x < 0 || y < 0 || x + cx > compositor->width || y + cy > compositor->pages * 8 || cx <= 0 || cy <= 0) {
+        return;
+    }
+
+    uint8_t  first_page = y / 8;
+    uint8_t  pages      = (y + cy - 1) / 8 - first_page + 1;
+    uint16_t size       = cx * pages;
+    if (size > LCD_STRIP_CACHE_SIZE) {
+        return;
+    }
+
+    lcd_strip_t* strip = find_strip(key, x, y);
+    if (!strip) {
+        // The entries and their data are both reused in the order they were
+        // saved in, so the oldest strip goes first
+        strip = &strips[next_strip];
+        next_strip = (next_strip + 1) % LCD_STRIP_CACHE_ENTRIES;
+    }
+    if (strip_data_end + size > LCD_STRIP_CACHE_SIZE) {
+        strip_data_end = 0;
+    }
+    for (uint8_t i = 0; i < LCD_STRIP_CACHE_ENTRIES; i++) {
+        if (strips[i].key && strips[i].offset < strip_data_end + size && strip_data_end < strips[i].offset + strips[i].width * strips[i].pages) {
+            strips[i].key = NULL;
+        }
+    }
+
+    strip->key    = key;
+    strip->tag    = tag;
+    strip->x      = x;
+    strip->y      = y;
+    strip->width  = cx;
+    strip->pages  = pages;
+    strip->offset = strip_data_end;
+    for (uint8_t page = 0; page < pages; page++) {
+        memcpy(&strip_data[strip->offset + page * cx], &compositor->frame[(first_page + page) * compositor->width + x], cx);
+    }
+    strip_data_end += size;
+}
+
+bool lcd_strip_draw(lcd_compositor_t* compositor, const void* key, uint32_t tag, int x, int y) {
+    lcd_strip_t* strip = find_strip(key, x, y);
+    if (!strip || strip->tag != tag) {
+        return false;
+    }
+
+    uint8_t first_page = y / 8;
+    for (uint8_t page = 0; page < strip->pages; page++) {
+        memcpy(&compositor->frame[(first_page + page) * compositor->width + x], &strip_data[strip->offset + page * strip->width], strip->width);
+    }
+    lcd_compositor_damage(compositor, x, first_page * 8, strip->width, strip->pages * 8);
+    return true;
+}
+
+void lcd_strip_cache_clear(void) {
+    memset(strips, 0, sizeof(strips));
+    strip_data_end = 0;
+    next_strip     = 0;
+}
@@ -0,0 +1,88 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QUANTUM_VISUALIZER_LCD_COMPOSITOR_H_
+#define QUANTUM_VISUALIZER_LCD_COMPOSITOR_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// The compositor keeps track of which parts of a monochrome frame have been
+// drawn to, and pushes only the bytes that differ from what the display shows.
+// The frame is laid out like the memory of the ST7565, each byte is a column
+// of 8 pixels, the least significant bit at the top, and each page is a row of
+// such bytes across the width of the display.
+
+#ifndef LCD_COMPOSITOR_MAX_PAGES
+#    define LCD_COMPOSITOR_MAX_PAGES 8
+#endif
+
+// Define these in config.h
+#ifndef LCD_STRIP_CACHE_SIZE
+// Bytes of rendered text that are kept around
+#    define LCD_STRIP_CACHE_SIZE 512
+#endif
+#ifndef LCD_STRIP_CACHE_ENTRIES
+#    define LCD_STRIP_CACHE_ENTRIES 8
+#endif
+
+// Columns from first up to last (not included) of each page
+typedef struct {
+    uint8_t first[LCD_COMPOSITOR_MAX_PAGES];
+    uint8_t last[LCD_COMPOSITOR_MAX_PAGES];
+} lcd_damage_t;
+
+typedef struct {
+    uint8_t* frame;
+    uint8_t  width;
+    uint8_t  pages;
+    // Displays like the ST7565 can hold two frames and flip between them, each
+    // has its own copy of what it shows and of what has been drawn since
+    uint8_t      buffers;
+    uint8_t      back;
+    uint8_t*     shown[2];
+    bool         shown_valid[2];
+    lcd_damage_t damage[2];
+} lcd_compositor_t;
+
+// Writes length bytes to the given page of the back buffer, starting at column
+typedef void (*lcd_push_func)(void* context, uint8_t page, uint8_t column, const uint8_t* data, uint8_t length);
+
+// The compositor of the display that the keyframes draw on, set by its driver
+extern lcd_compositor_t* lcd_compositor;
+
+void lcd_damage_clear(lcd_damage_t* damage);
+void lcd_damage_add(lcd_damage_t* damage, uint8_t page, uint8_t first, uint8_t last);
+
+// shown needs to hold one frame for each buffer
+void lcd_compositor_init(lcd_compositor_t* compositor, uint8_t* frame, uint8_t* shown, uint8_t width, uint8_t height, uint8_t buffers);
+// Call this for anything drawn on the frame
+void lcd_compositor_damage(lcd_compositor_t* compositor, int x, int y, int cx, int cy);
+// Pushes what has changed to the back buffer and makes it the front buffer.
+// Returns the number of bytes pushed.
+uint16_t lcd_compositor_push(lcd_compositor_t* compositor, lcd_push_func push, void* context);
+
+// Copies the pixels from x, y up to cx, cy to the cache, full bytes at a time.
+// Nothing else should be drawn in the same bytes, as it would be cached too.
+// The tag tells apart what has been saved under the same key, e.g. a hash of
+// the text in a buffer that is reused, it replaces what was saved before.
+void lcd_strip_save(lcd_compositor_t* compositor, const void* key, uint32_t tag, int x, int y, int cx, int cy);
+// Copies the strip saved with the same key, tag and position back to the
+// frame. Returns false if it isn't in the cache.
+bool lcd_strip_draw(lcd_compositor_t* compositor, const void* key, uint32_t tag, int x, int y);
+void lcd_strip_cache_clear(void);
+
+#endif /* QUANTUM_VISUALIZER_LCD_COMPOSITOR_H_ */
@@ -19,11 +19,34 @@
 #include "action_util.h"
 #include "led.h"
 #include "resources/resources.h"
+#include "lcd_compositor.h"
+
+// FNV-1a, keymaps can change the text in the buffer they point layer_text at
+static uint32_t hash_text(const char* text) {
+    uint32_t hash = 2166136261UL;
+    while (*text) {
+        hash = (hash ^ (uint8_t)*text++) * 16777619UL;
+    }
+    return hash;
+}
+
+// Copying the text from the cache is much faster than rendering it, so each
+// layer text is only rendered the first time it's shown
+static void draw_layer_text(coord_t y, visualizer_state_t* state) {
+    uint32_t hash = hash_text(state->layer_text);
+    if (lcd_compositor && lcd_strip_draw(lcd_compositor, state->layer_text, hash, 0, y)) {
+        return;
+    }
+    gdispDrawString(0, y, state->layer_text, state->font_dejavusansbold12, Black);
+    if (lcd_compositor) {
+        lcd_strip_save(lcd_compositor, state->layer_text, hash, 0, y, gdispGetStringWidth(state->layer_text, state->font_dejavusansbold12), gdispGetFontMetric(state->font_dejavusansbold12, fontHeight));
+    }
+}
 
 bool lcd_keyframe_display_layer_text(keyframe_animation_t* animation, visualizer_state_t* state) {
     (void)animation;
     gdispClear(White);
-    gdispDrawString(0, 10, state->layer_text, state->font_dejavusansbold12, Black);
+    draw_layer_text(10, state);
     return false;
 }
 
@@ -148,7 +171,7 @@ bool lcd_keyframe_display_layer_and_led_states(keyframe_animation_t* animation,
         gdispDrawString(0, 1, output, state->font_dejavusansbold12, Black);
         y = 17;
     }
-    gdispDrawString(0, y, state->layer_text, state->font_dejavusansbold12, Black);
+    draw_layer_text(y, state);
     return false;
 }
 
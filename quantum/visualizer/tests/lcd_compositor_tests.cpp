@@ -0,0 +1,241 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include <cstdio>
+#include <cstring>
+extern "C" {
+#include "visualizer/lcd_compositor.h"
+}
+
+// The ST7565 of the Ergodox Infinity, which holds two frames
+#define WIDTH 128
+#define HEIGHT 32
+#define FRAME_SIZE (WIDTH * HEIGHT / 8)
+
+// Stands in for the display RAM, in the same layout as the frame
+static uint8_t  panel[2][FRAME_SIZE];
+static uint32_t pushed_bytes;
+static uint32_t pushed_spans;
+
+static void push(void* context, uint8_t page, uint8_t column, const uint8_t* data, uint8_t length) {
+    uint8_t* buffer = (uint8_t*)context;
+    memcpy(&buffer[page * WIDTH + column], data, length);
+    pushed_bytes += length;
+    pushed_spans++;
+}
+
+class LcdCompositor : public testing::Test {
+   public:
+    void SetUp() override {
+        memset(frame, 0xFF, sizeof(frame));
+        memset(panel, 0x55, sizeof(panel));
+        lcd_compositor_init(&compositor, frame, &shown[0][0], WIDTH, HEIGHT, 2);
+        lcd_strip_cache_clear();
+        pushed_bytes = 0;
+        pushed_spans = 0;
+    }
+
+    // Draws like the driver does, white pixels are set bits
+    void draw_pixel(int x, int y, bool white) {
+        if (white) {
+            frame[x + (y / 8) * WIDTH] |= 1 << (y % 8);
+        } else {
+            frame[x + (y / 8) * WIDTH] &= ~(1 << (y % 8));
+        }
+        lcd_compositor_damage(&compositor, x, y, 1, 1);
+    }
+
+    void clear(void) {
+        for (int y = 0; y < HEIGHT; y++) {
+            for (int x = 0; x < WIDTH; x++) {
+                draw_pixel(x, y, true);
+            }
+        }
+    }
+
+    // Something like a 12 pixel high font, with a different pattern for every
+    // character, returns the width
+    int draw_text(int x, int y, const char* text) {
+        int start = x;
+        for (; *text; text++) {
+            for (int column = 0; column < 7; column++, x++) {
+                for (int row = 0; row < 12; row++) {
+                    draw_pixel(x, y + row, !(((*text * (column + 3)) >> (row % 6)) & 1));
+                }
+            }
+            x++;
+        }
+        return x - start;
+    }
+
+    uint32_t push_to_panel(void) {
+        uint8_t  back   = compositor.back;
+        uint32_t before = pushed_bytes;
+        lcd_compositor_push(&compositor, push, panel[back]);
+        EXPECT_EQ(memcmp(panel[back], frame, FRAME_SIZE), 0);
+        return pushed_bytes - before;
+    }
+
+    uint8_t          frame[FRAME_SIZE];
+    uint8_t          shown[2][FRAME_SIZE];
+    lcd_compositor_t compositor;
+};
+
+TEST_F(LcdCompositor, FirstPushSendsEverything) {
+    clear();
+    EXPECT_EQ(push_to_panel(), FRAME_SIZE);
+    EXPECT_EQ(push_to_panel(), FRAME_SIZE);
+    EXPECT_EQ(push_to_panel(), 0);
+}
+
+TEST_F(LcdCompositor, NothingDrawnNothingPushed) {
+    clear();
+    push_to_panel();
+    push_to_panel();
+    pushed_spans = 0;
+    EXPECT_EQ(push_to_panel(), 0);
+    EXPECT_EQ(pushed_spans, 0);
+}
+
+TEST_F(LcdCompositor, RedrawingTheSameIsNotPushed) {
+    clear();
+    draw_text(0, 10, "Qwerty");
+    push_to_panel();
+    push_to_panel();
+
+    clear();
+    draw_text(0, 10, "Qwerty");
+    EXPECT_EQ(push_to_panel(), 0);
+    EXPECT_EQ(push_to_panel(), 0);
+}
+
+TEST_F(LcdCompositor, OnlyTheChangePushedToBothBuffers) {
+    clear();
+    draw_text(0, 10, "Qwerty");
+    push_to_panel();
+    push_to_panel();
+
+    clear();
+    draw_text(0, 10, "Qwertz");
+    // The last character, on the three pages that the text covers
+    uint32_t pushed = push_to_panel();
+    EXPECT_GT(pushed, 0);
+    EXPECT_LE(pushed, 3 * 8);
+    // The other buffer still shows the old text
+    EXPECT_EQ(push_to_panel(), pushed);
+    EXPECT_EQ(push_to_panel(), 0);
+}
+
+TEST_F(LcdCompositor, SingleBuffer) {
+    lcd_compositor_init(&compositor, frame, &shown[0][0], WIDTH, HEIGHT, 1);
+    clear();
+    push_to_panel();
+    draw_pixel(5, 5, false);
+    EXPECT_EQ(push_to_panel(), 1);
+    EXPECT_EQ(push_to_panel(), 0);
+}
+
+TEST_F(LcdCompositor, DamageIsClipped) {
+    clear();
+    push_to_panel();
+    push_to_panel();
+    lcd_compositor_damage(&compositor, -10, -10, 1000, 1000);
+    frame[FRAME_SIZE - 1] = 0;
+    EXPECT_EQ(push_to_panel(), 1);
+}
+
+TEST_F(LcdCompositor, StripCache) {
+    const char* text = "Symbols";
+    clear();
+    int width = draw_text(0, 10, text);
+    lcd_strip_save(&compositor, text, 0, 0, 10, width, 12);
+    uint8_t rendered[FRAME_SIZE];
+    memcpy(rendered, frame, FRAME_SIZE);
+
+    clear();
+    EXPECT_FALSE(lcd_strip_draw(&compositor, text, 0, 0, 17));
+    EXPECT_FALSE(lcd_strip_draw(&compositor, "Other", 0, 0, 10));
+    EXPECT_TRUE(lcd_strip_draw(&compositor, text, 0, 0, 10));
+    EXPECT_EQ(memcmp(rendered, frame, FRAME_SIZE), 0);
+}
+
+TEST_F(LcdCompositor, StripCacheTellsApartTags) {
+    // A buffer that is reused for different texts, tagged with what is in it
+    char text[16] = "Symbols";
+    clear();
+    int width = draw_text(0, 10, text);
+    lcd_strip_save(&compositor, text, 1, 0, 10, width, 12);
+
+    strcpy(text, "Function");
+    clear();
+    EXPECT_FALSE(lcd_strip_draw(&compositor, text, 2, 0, 10));
+    width = draw_text(0, 10, text);
+    lcd_strip_save(&compositor, text, 2, 0, 10, width, 12);
+    uint8_t rendered[FRAME_SIZE];
+    memcpy(rendered, frame, FRAME_SIZE);
+
+    // The new text replaced the old one
+    clear();
+    EXPECT_FALSE(lcd_strip_draw(&compositor, text, 1, 0, 10));
+    EXPECT_TRUE(lcd_strip_draw(&compositor, text, 2, 0, 10));
+    EXPECT_EQ(memcmp(rendered, frame, FRAME_SIZE), 0);
+}
+
+TEST_F(LcdCompositor, StripCacheDropsTheOldest) {
+    static const char* texts[] = {"Qwerty", "Dvorak", "Symbols", "Function", "Mirrored Qwerty", "Mirrored Dvorak", "Numpad", "Mouse", "Game", "Adjust"};
+    const int          count   = sizeof(texts) / sizeof(texts[0]);
+    static uint8_t     rendered[count][FRAME_SIZE];
+
+    for (int i = 0; i < count; i++) {
+        clear();
+        int width = draw_text(0, 10, texts[i]);
+        lcd_strip_save(&compositor, texts[i], 0, 0, 10, width, 12);
+        memcpy(rendered[i], frame, FRAME_SIZE);
+    }
+
+    // Whatever is still cached has to be right, and the latest ones are
+    for (int i = 0; i < count; i++) {
+        clear();
+        if (lcd_strip_draw(&compositor, texts[i], 0, 0, 10)) {
+            EXPECT_EQ(memcmp(rendered[i], frame, FRAME_SIZE), 0);
+        } else {
+            EXPECT_LT(i, count - 2);
+        }
+    }
+}
+
+TEST_F(LcdCompositor, PixelsPushedPerTransition) {
+    static const char* layers[] = {"Qwerty", "Symbols", "Function", "Qwerty", "Mirrored Qwerty", "Qwerty"};
+    clear();
+    draw_text(0, 10, layers[0]);
+    push_to_panel();
+    push_to_panel();
+
+    for (size_t i = 1; i < sizeof(layers) / sizeof(layers[0]); i++) {
+        // What the layer text keyframe does
+        clear();
+        if (!lcd_strip_draw(&compositor, layers[i], 0, 0, 10)) {
+            int width = draw_text(0, 10, layers[i]);
+            lcd_strip_save(&compositor, layers[i], 0, 0, 10, width, 12);
+        }
+        uint32_t pushed = push_to_panel();
+        EXPECT_LT(pushed, FRAME_SIZE / 2);
+        printf("%s -> %s: %u of %u pixels pushed\n", layers[i - 1], layers[i], (unsigned)pushed * 8, FRAME_SIZE * 8);
+        // Let the other buffer catch up
+        push_to_panel();
+    }
+}
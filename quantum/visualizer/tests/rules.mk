@@ -0,0 +1,3 @@
+lcd_compositor_SRC :=\
+	$(QUANTUM_PATH)/visualizer/tests/lcd_compositor_tests.cpp \
+	$(QUANTUM_PATH)/visualizer/lcd_compositor.c
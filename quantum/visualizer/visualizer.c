@@ -49,6 +49,7 @@ SOFTWARE.
 #endif
 
 #include "action_util.h"
+#include "timer.h"
 
 // Define this in config.h
 #ifndef VISUALIZER_THREAD_PRIORITY
@@ -56,6 +57,13 @@ SOFTWARE.
 #    define VISUALIZER_THREAD_PRIORITY (NORMAL_PRIORITY - 2)
 #endif
 
+// Define this in config.h
+#ifndef VISUALIZER_FRAME_TIME
+// In milliseconds, how often animations that want continuous updates are
+// drawn, and how often at most changes to the keyboard status are passed on
+#    define VISUALIZER_FRAME_TIME 10
+#endif
+
 static visualizer_keyboard_status_t current_status = {.layer         = 0xFFFFFFFF,
                                                       .default_layer = 0xFFFFFFFF,
                                                       .leds          = 0xFFFFFFFF,
@@ -82,9 +90,11 @@ static bool same_status(visualizer_keyboard_status_t* status1, visualizer_keyboa
 
 static bool visualizer_enabled = false;
 
-#ifdef VISUALIZER_USER_DATA_SIZE
-static uint8_t user_data[VISUALIZER_USER_DATA_SIZE];
-#endif
+// The status of this keyboard as the hooks below see it. It's copied to the
+// current status by visualizer_task(), when it has changed.
+static visualizer_keyboard_status_t local_status;
+static bool                         local_status_changed = false;
+static uint16_t                     last_status_copy     = 0;
 
 #define MAX_SIMULTANEOUS_ANIMATIONS 4
 static keyframe_animation_t* animations[MAX_SIMULTANEOUS_ANIMATIONS] = {};
@@ -205,7 +215,12 @@ static bool update_keyframe_animation(keyframe_animation_t* animation, visualize
         animation->first_update_of_frame = false;
     }
 
-    systemticks_t wanted_sleep = animation->need_update ? gfxMillisecondsToTicks(10) : (unsigned)animation->time_left_in_frame;
+    // Sleep until the frame ends, waking up once every frame time before that
+    // if the frame wants continuous updates
+    systemticks_t wanted_sleep = (unsigned)animation->time_left_in_frame;
+    if (animation->need_update && wanted_sleep > gfxMillisecondsToTicks(VISUALIZER_FRAME_TIME)) {
+        wanted_sleep = gfxMillisecondsToTicks(VISUALIZER_FRAME_TIME);
+    }
     if (wanted_sleep < *sleep_time) {
         *sleep_time = wanted_sleep;
     }
@@ -365,6 +380,12 @@ static DECLARE_THREAD_FUNCTION(visualizerThread, arg) {
     return 0;
 }
 
+static void visualizer_layer_changed(const layer_info_t* info) {
+    local_status.layer         = info->state;
+    local_status.default_layer = info->default_state;
+    local_status_changed       = true;
+}
+
 void visualizer_init(void) {
     gfxInit();
 
@@ -376,6 +397,9 @@ void visualizer_init(void) {
     add_remote_objects(remote_objects, sizeof(remote_objects) / sizeof(remote_object_t*));
 #endif
 
+    visualizer_layer_changed(get_layer_info());
+    layer_change_subscribe(visualizer_layer_changed);
+
 #ifdef LCD_ENABLE
     LCD_DISPLAY = get_lcd_display();
 #endif
@@ -420,16 +444,42 @@ uint8_t visualizer_get_mods() {
     return mods;
 }
 
+void visualizer_set_mods(uint8_t mods) {
+    if (local_status.mods != mods) {
+        local_status.mods    = mods;
+        local_status_changed = true;
+    }
+}
+
+void visualizer_set_leds(uint32_t leds) {
+    if (local_status.leds != leds) {
+        local_status.leds    = leds;
+        local_status_changed = true;
+    }
+}
+
 #ifdef VISUALIZER_USER_DATA_SIZE
-void visualizer_set_user_data(void* u) { memcpy(user_data, u, VISUALIZER_USER_DATA_SIZE); }
+void visualizer_set_user_data(void* u) {
+    if (memcmp(local_status.user_data, u, VISUALIZER_USER_DATA_SIZE) != 0) {
+        memcpy(local_status.user_data, u, VISUALIZER_USER_DATA_SIZE);
+        local_status_changed = true;
+    }
+}
 #endif
 
-void visualizer_update(layer_state_t default_state, layer_state_t state, uint8_t mods, uint32_t leds) {
+void visualizer_task(void) {
     // Note that there's a small race condition here, the thread could read
     // a state where one of these are set but not the other. But this should
     // not really matter as it will be fixed during the next loop step.
     // Alternatively a mutex could be used instead of the volatile variables
 
+#ifndef NO_ACTION_ONESHOT
+    // One shot mods that time out don't call anything
+    if (get_oneshot_mods()) {
+        visualizer_set_mods(visualizer_get_mods());
+    }
+#endif
+
     bool changed = false;
 #ifdef SERIAL_LINK_ENABLE
     if (is_serial_link_connected()) {
@@ -444,22 +494,19 @@ void visualizer_update(layer_state_t default_state, layer_state_t state, uint8_t
 #else
     {
 #endif
-        visualizer_keyboard_status_t new_status = {
-            .layer         = state,
-            .default_layer = default_state,
-            .mods          = mods,
-            .leds          = leds,
+        // A burst of changes only wakes up the visualizer thread once a frame
+        if (local_status_changed && timer_elapsed(last_status_copy) >= VISUALIZER_FRAME_TIME) {
+            visualizer_keyboard_status_t new_status = local_status;
+            new_status.suspended                    = current_status.suspended;
 #ifdef BACKLIGHT_ENABLE
-            .backlight_level = current_status.backlight_level,
-#endif
-            .suspended = current_status.suspended,
-        };
-#ifdef VISUALIZER_USER_DATA_SIZE
-        memcpy(new_status.user_data, user_data, VISUALIZER_USER_DATA_SIZE);
+            new_status.backlight_level = current_status.backlight_level;
 #endif
-        if (!same_status(&current_status, &new_status)) {
-            changed        = true;
-            current_status = new_status;
+            local_status_changed = false;
+            last_status_copy     = timer_read();
+            if (!same_status(&current_status, &new_status)) {
+                changed        = true;
+                current_status = new_status;
+            }
         }
     }
     update_status(changed);
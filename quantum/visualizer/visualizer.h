@@ -45,8 +45,13 @@ uint8_t visualizer_get_mods(void);
 
 // This need to be called once at the start
 void visualizer_init(void);
-// This should be called at every matrix scan
-void visualizer_update(layer_state_t default_state, layer_state_t state, uint8_t mods, uint32_t leds);
+// This should be called at every matrix scan, it passes on the changes that
+// have been made since the last frame
+void visualizer_task(void);
+// These should be called when the mods or the host leds change, the layers
+// are followed through layer_change_subscribe
+void visualizer_set_mods(uint8_t mods);
+void visualizer_set_leds(uint32_t leds);
 
 // This should be called when the keyboard goes to suspend state
 void visualizer_suspend(void);
@@ -88,6 +93,8 @@ typedef struct {
 typedef struct visualizer_state_t {
     // The user code should primarily be modifying these
     uint32_t    target_lcd_color;
+    // The rendered text is cached by this pointer, so it should point to text
+    // that doesn't change, like a string literal
     const char* layer_text;
 
     // The user visualizer(and animation functions) can read these
@@ -2,6 +2,14 @@ TEST_LIST = $(notdir $(patsubst %/rules.mk,%,$(wildcard $(ROOT_DIR)/tests/*/rule
 FULL_TESTS := $(TEST_LIST)
 
 include $(ROOT_DIR)/quantum/serial_link/tests/testlist.mk
+include $(ROOT_DIR)/quantum/audio/tests/testlist.mk
+include $(ROOT_DIR)/quantum/tests/testlist.mk
+include $(ROOT_DIR)/quantum/visualizer/tests/testlist.mk
+include $(ROOT_DIR)/drivers/i2c_queue/tests/testlist.mk
+include $(ROOT_DIR)/drivers/oled/tests/testlist.mk
+include $(ROOT_DIR)/drivers/eeprom/tests/testlist.mk
+include $(ROOT_DIR)/tmk_core/protocol/tests/testlist.mk
+include $(ROOT_DIR)/tmk_core/common/tests/testlist.mk
 
 define VALIDATE_TEST_LIST
     ifneq ($1,)
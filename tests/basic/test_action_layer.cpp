@@ -17,6 +17,7 @@
 #include "test_common.hpp"
 
 using testing::_;
+using testing::AnyNumber;
 using testing::Return;
 
 class ActionLayer : public TestFixture {};
@@ -90,3 +91,72 @@ TEST_F(ActionLayer, LayerStateCmp) {
 //     layer_off(2);
 //     EXPECT_EQ(layer_state, 0b1000);
 // }
+
+static int          layer_changes;
+static layer_info_t last_layer_info;
+
+static void count_layer_changes(const layer_info_t *info) {
+    layer_changes++;
+    last_layer_info = *info;
+}
+
+TEST_F(ActionLayer, LayerChangeOncePerChange) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+
+    ASSERT_TRUE(layer_change_subscribe(count_layer_changes));
+    layer_clear();
+    layer_changes = 0;
+
+    layer_on(1);
+    layer_on(1);
+    layer_on(3);
+    layer_off(2);
+    EXPECT_EQ(layer_changes, 2);
+    EXPECT_EQ(last_layer_info.state, 0b1010);
+    EXPECT_EQ(last_layer_info.highest_layer, 3);
+    EXPECT_EQ(last_layer_info.generation, get_layer_info()->generation);
+
+    layer_off(3);
+    EXPECT_EQ(layer_changes, 3);
+    EXPECT_EQ(last_layer_info.highest_layer, 1);
+
+    layer_change_unsubscribe(count_layer_changes);
+    layer_clear();
+    EXPECT_EQ(layer_changes, 3);
+}
+
+TEST_F(ActionLayer, LayerChangeDerivedState) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+
+    default_layer_set(1);
+    layer_state_set(0b10100);
+
+    const layer_info_t *info = get_layer_info();
+    EXPECT_EQ(info->default_state, 1);
+    EXPECT_EQ(info->state, 0b10100);
+    EXPECT_EQ(info->highest_layer, 4);
+    EXPECT_EQ(info->active_layers, 3);
+
+    default_layer_set(0);
+}
+
+TEST_F(ActionLayer, LayerChangeDirectWrite) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+
+    ASSERT_TRUE(layer_change_subscribe(count_layer_changes));
+    layer_clear();
+    layer_changes = 0;
+
+    layer_state = 0b100;
+    run_one_scan_loop();
+    EXPECT_EQ(layer_changes, 1);
+    EXPECT_EQ(last_layer_info.highest_layer, 2);
+
+    run_one_scan_loop();
+    EXPECT_EQ(layer_changes, 1);
+
+    layer_change_unsubscribe(count_layer_changes);
+}
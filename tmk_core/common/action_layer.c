@@ -1,4 +1,5 @@
 #include <stdint.h>
+#include <stddef.h>
 #include "keyboard.h"
 #include "action.h"
 #include "util.h"
@@ -14,6 +15,8 @@
  */
 layer_state_t default_layer_state = 0;
 
+static void layer_info_update(void);
+
 /** \brief Default Layer State Set At user Level
  *
  * Run user code on default layer state change
@@ -43,6 +46,7 @@ static void default_layer_state_set(layer_state_t state) {
 #else
     clear_keyboard_but_mods_and_keys();  // Don't reset held keys
 #endif
+    layer_info_update();
 }
 
 /** \brief Default Layer Print
@@ -109,6 +113,7 @@ void layer_state_set(layer_state_t state) {
 #    else
     clear_keyboard_but_mods_and_keys();  // Don't reset held keys
 #    endif
+    layer_info_update();
 }
 
 /** \brief Layer clear
@@ -181,6 +186,87 @@ void layer_xor(layer_state_t state) { layer_state_set(layer_state ^ state); }
 void layer_debug(void) { dprintf("%08lX(%u)", layer_state, get_highest_layer(layer_state)); }
 #endif
 
+static layer_info_t           layer_info;
+static layer_change_handler_t layer_change_handlers[LAYER_CHANGE_HANDLERS];
+
+/** \brief Layer info update
+ *
+ * Recalculates the layer info if either layer state has changed since it was
+ * last done, and tells the subscribers about it
+ */
+static void layer_info_update(void) {
+    if (layer_info.state == layer_state && layer_info.default_state == default_layer_state) {
+        return;
+    }
+
+    layer_state_t layers     = layer_state | default_layer_state;
+    layer_info.default_state = default_layer_state;
+    layer_info.state         = layer_state;
+    layer_info.highest_layer = get_highest_layer(layers);
+    layer_info.active_layers = 0;
+    for (; layers; layers &= layers - 1) {
+        layer_info.active_layers++;
+    }
+    layer_info.generation++;
+
+    // A handler may change the layers again, the ones after it then only see
+    // the latest state, once
+    uint16_t generation = layer_info.generation;
+    for (uint8_t i = 0; i < LAYER_CHANGE_HANDLERS && generation == layer_info.generation; i++) {
+        if (layer_change_handlers[i]) {
+            layer_change_handlers[i](&layer_info);
+        }
+    }
+}
+
+/** \brief Layer change subscribe
+ *
+ * Calls the handler every time the layer state or the default layer state
+ * changes. Returns false if there are already LAYER_CHANGE_HANDLERS of them.
+ */
+bool layer_change_subscribe(layer_change_handler_t handler) {
+    for (uint8_t i = 0; i < LAYER_CHANGE_HANDLERS; i++) {
+        if (layer_change_handlers[i] == handler) {
+            return true;
+        }
+    }
+    for (uint8_t i = 0; i < LAYER_CHANGE_HANDLERS; i++) {
+        if (!layer_change_handlers[i]) {
+            layer_change_handlers[i] = handler;
+            return true;
+        }
+    }
+    return false;
+}
+
+/** \brief Layer change unsubscribe
+ *
+ * Stops calling the handler on layer changes
+ */
+void layer_change_unsubscribe(layer_change_handler_t handler) {
+    for (uint8_t i = 0; i < LAYER_CHANGE_HANDLERS; i++) {
+        if (layer_change_handlers[i] == handler) {
+            layer_change_handlers[i] = NULL;
+        }
+    }
+}
+
+/** \brief Get layer info
+ *
+ * Returns the layer states, and what is derived from them, as of now
+ */
+const layer_info_t *get_layer_info(void) {
+    layer_info_update();
+    return &layer_info;
+}
+
+/** \brief Layer change task
+ *
+ * Catches changes made by writing to layer_state or default_layer_state
+ * directly, instead of through layer_state_set() and default_layer_set()
+ */
+void layer_change_task(void) { layer_info_update(); }
+
 #if !defined(NO_ACTION_LAYER) && !defined(STRICT_LAYER_RELEASE)
 /** \brief source layer cache
  */
@@ -255,9 +341,10 @@ uint8_t layer_switch_get_layer(keypos_t key) {
     action_t action;
     action.code = ACTION_TRANSPARENT;
 
-    layer_state_t layers = layer_state | default_layer_state;
+    const layer_info_t *info   = get_layer_info();
+    layer_state_t       layers = info->state | info->default_state;
     /* check top layer first */
-    for (int8_t i = sizeof(layer_state_t) * 8 - 1; i >= 0; i--) {
+    for (int8_t i = info->highest_layer; i >= 0; i--) {
         if (layers & (1UL << i)) {
             action = action_for_key(i, key);
             if (action.code != ACTION_TRANSPARENT) {
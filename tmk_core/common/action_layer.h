@@ -94,6 +94,28 @@ void layer_xor(layer_state_t state);
 layer_state_t layer_state_set_user(layer_state_t state);
 layer_state_t layer_state_set_kb(layer_state_t state);
 
+/*
+ * Layer changes
+ */
+#ifndef LAYER_CHANGE_HANDLERS
+#    define LAYER_CHANGE_HANDLERS 4
+#endif
+
+typedef struct {
+    layer_state_t default_state;
+    layer_state_t state;
+    uint8_t       highest_layer;  // topmost layer that is on in either state
+    uint8_t       active_layers;  // how many layers are on in either state
+    uint16_t      generation;     // goes up by one with every change
+} layer_info_t;
+
+typedef void (*layer_change_handler_t)(const layer_info_t *info);
+
+bool                layer_change_subscribe(layer_change_handler_t handler);
+void                layer_change_unsubscribe(layer_change_handler_t handler);
+const layer_info_t *get_layer_info(void);
+void                layer_change_task(void);
+
 /* pressed actions cache */
 #if !defined(NO_ACTION_LAYER) && !defined(STRICT_LAYER_RELEASE)
 /* The number of bits needed to represent the layer number: log2(32). */
@@ -21,6 +21,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "action_layer.h"
 #include "timer.h"
 #include "keycode_config.h"
+#ifdef VISUALIZER_ENABLE
+#    include "visualizer/visualizer.h"
+#endif
 
 extern keymap_config_t keymap_config;
 
@@ -161,26 +164,47 @@ void send_keyboard_report(void) {
  * FIXME: needs doc
  */
 uint8_t get_mods(void) { return real_mods; }
+/** \brief Mods changed
+ *
+ * Passes the real and one shot mods on to whoever follows them
+ */
+static inline void mods_changed(void) {
+#ifdef VISUALIZER_ENABLE
+    visualizer_set_mods(visualizer_get_mods());
+#endif
+}
 /** \brief add mods
  *
  * FIXME: needs doc
  */
-void add_mods(uint8_t mods) { real_mods |= mods; }
+void add_mods(uint8_t mods) {
+    real_mods |= mods;
+    mods_changed();
+}
 /** \brief del mods
  *
  * FIXME: needs doc
  */
-void del_mods(uint8_t mods) { real_mods &= ~mods; }
+void del_mods(uint8_t mods) {
+    real_mods &= ~mods;
+    mods_changed();
+}
 /** \brief set mods
  *
  * FIXME: needs doc
  */
-void set_mods(uint8_t mods) { real_mods = mods; }
+void set_mods(uint8_t mods) {
+    real_mods = mods;
+    mods_changed();
+}
 /** \brief clear mods
  *
  * FIXME: needs doc
  */
-void clear_mods(void) { real_mods = 0; }
+void clear_mods(void) {
+    real_mods = 0;
+    mods_changed();
+}
 
 /** \brief get weak mods
  *
@@ -246,6 +270,7 @@ void set_oneshot_mods(uint8_t mods) {
         oneshot_time = timer_read();
 #    endif
         oneshot_mods = mods;
+        mods_changed();
         oneshot_mods_changed_kb(mods);
     }
 }
@@ -259,6 +284,7 @@ void clear_oneshot_mods(void) {
 #    if (defined(ONESHOT_TIMEOUT) && (ONESHOT_TIMEOUT > 0))
         oneshot_time = 0;
 #    endif
+        mods_changed();
         oneshot_mods_changed_kb(oneshot_mods);
     }
 }
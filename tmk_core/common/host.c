@@ -100,3 +100,7 @@ void host_consumer_send(uint16_t report) {
 uint16_t host_last_system_report(void) { return last_system_report; }
 
 uint16_t host_last_consumer_report(void) { return last_consumer_report; }
+
+/* Interval the host polls keyboard reports at, in microseconds, or 0 if the
+ * protocol can't tell */
+__attribute__((weak)) uint32_t host_polling_interval_us(void) { return 0; }
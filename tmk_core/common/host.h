@@ -51,6 +51,8 @@ void    host_consumer_send(uint16_t data);
 uint16_t host_last_system_report(void);
 uint16_t host_last_consumer_report(void);
 
+uint32_t host_polling_interval_us(void);
+
 #ifdef __cplusplus
 }
 #endif
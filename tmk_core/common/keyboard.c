@@ -56,6 +56,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifdef STENO_ENABLE
 #    include "process_steno.h"
 #endif
+#if defined(UNICODE_ENABLE) || defined(UNICODEMAP_ENABLE) || defined(UCIS_ENABLE)
+#    include "process_unicode_common.h"
+#endif
 #ifdef FAUXCLICKY_ENABLE
 #    include "fauxclicky.h"
 #endif
@@ -77,6 +80,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifdef QWIIC_ENABLE
 #    include "qwiic.h"
 #endif
+#ifdef I2C_QUEUE_ENABLE
+#    include "i2c_queue.h"
+#endif
 #ifdef OLED_DRIVER_ENABLE
 #    include "oled_driver.h"
 #endif
@@ -86,6 +92,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifdef VIA_ENABLE
 #    include "via.h"
 #endif
+#ifdef EEPROM_DRIVER
+#    include "eeprom_driver.h"
+#endif
 
 // Only enable this if console is enabled to print to
 #if defined(DEBUG_MATRIX_SCAN_RATE) && defined(CONSOLE_ENABLE)
@@ -331,6 +340,8 @@ void keyboard_task(void) {
 
 MATRIX_LOOP_END:
 
+    layer_change_task();
+
 #ifdef DEBUG_MATRIX_SCAN_RATE
     matrix_scan_perf_task();
 #endif
@@ -345,6 +356,10 @@ MATRIX_LOOP_END:
 #    endif
 #endif
 
+#ifdef I2C_QUEUE_ENABLE
+    i2c_queue_task();
+#endif
+
 #ifdef QWIIC_ENABLE
     qwiic_task();
 #endif
@@ -357,6 +372,15 @@ MATRIX_LOOP_END:
 #    endif
 #endif
 
+#ifdef STENO_ENABLE
+    // send the chords completed during this scan
+    steno_task();
+#endif
+
+#if defined(UNICODE_ENABLE) || defined(UNICODEMAP_ENABLE) || defined(UCIS_ENABLE)
+    unicode_task();
+#endif
+
 #ifdef MOUSEKEY_ENABLE
     // mousekey repeat & acceleration
     mousekey_task();
@@ -379,7 +403,7 @@ MATRIX_LOOP_END:
 #endif
 
 #ifdef VISUALIZER_ENABLE
-    visualizer_update(default_layer_state, layer_state, visualizer_get_mods(), host_keyboard_leds());
+    visualizer_task();
 #endif
 
 #ifdef POINTING_DEVICE_ENABLE
@@ -396,6 +420,10 @@ MATRIX_LOOP_END:
     }
 #endif
 
+#ifdef EEPROM_DRIVER
+    eeprom_driver_task();
+#endif
+
     // update LED
     if (led_status != host_keyboard_leds()) {
         led_status = host_keyboard_leds();
@@ -414,4 +442,7 @@ void keyboard_set_leds(uint8_t leds) {
         debug("\n");
     }
     led_set(leds);
+#ifdef VISUALIZER_ENABLE
+    visualizer_set_leds(leds);
+#endif
 }
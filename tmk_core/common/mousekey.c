@@ -33,127 +33,177 @@ inline int8_t times_inv_sqrt2(int8_t x) {
 
 static report_mouse_t mouse_report = {0};
 static void           mousekey_debug(void);
-static uint8_t        mousekey_accel  = 0;
-static uint8_t        mousekey_repeat = 0;
-static uint16_t       last_timer      = 0;
+static uint8_t        mousekey_accel = 0;
+static uint16_t       last_timer     = 0;
 
 #ifndef MK_3_SPEED
 
-static uint16_t last_timer_c = 0;
-static uint16_t last_timer_w = 0;
-
 /*
  * Mouse keys  acceleration algorithm
  *  http://en.wikipedia.org/wiki/Mouse_keys
  *
  *  speed = delta * max_speed * (repeat / time_to_max)**((1000+curve)/1000)
+ *
+ * The speed is applied continuously: every update moves by speed times the
+ * time since the last update, in 1/256 units, and fractions of a unit are
+ * carried over to the next report. Movement doesn't depend on how often
+ * mousekey_task() runs, only on how long the keys have been held.
  */
 /* milliseconds between the initial key press and first repeated motion event (0-2550) */
 uint8_t mk_delay = MOUSEKEY_DELAY / 10;
-/* milliseconds between repeated motion events (0-255) */
+/* milliseconds in which the speed is applied once (0-255) */
 uint8_t mk_interval = MOUSEKEY_INTERVAL;
-/* steady speed (in action_delta units) applied each event (0-255) */
+/* steady speed (in action_delta units) applied each interval (0-255) */
 uint8_t mk_max_speed = MOUSEKEY_MAX_SPEED;
-/* number of events (count) accelerating to steady speed (0-255) */
+/* number of intervals accelerating to steady speed (0-255) */
 uint8_t mk_time_to_max = MOUSEKEY_TIME_TO_MAX;
 /* ramp used to reach maximum pointer speed (NOT SUPPORTED) */
 // int8_t mk_curve = 0;
 /* wheel params */
 /* milliseconds between the initial key press and first repeated motion event (0-2550) */
 uint8_t mk_wheel_delay = MOUSEKEY_WHEEL_DELAY / 10;
-/* milliseconds between repeated motion events (0-255) */
+/* milliseconds in which the speed is applied once (0-255) */
 uint8_t mk_wheel_interval    = MOUSEKEY_WHEEL_INTERVAL;
 uint8_t mk_wheel_max_speed   = MOUSEKEY_WHEEL_MAX_SPEED;
 uint8_t mk_wheel_time_to_max = MOUSEKEY_WHEEL_TIME_TO_MAX;
 
-static uint8_t move_unit(void) {
+typedef struct {
+    uint32_t start;  // when the first key of this motion was pressed
+    uint32_t last;   // time up to which movement has been reported
+    uint16_t carry;  // fractions of a unit not reported yet, in 1/256
+} mousekey_motion_t;
+
+static mousekey_motion_t cursor;
+static mousekey_motion_t wheel;
+
+static uint16_t unit_for(uint8_t delta, uint8_t max_speed, uint8_t max) {
     uint16_t unit;
     if (mousekey_accel & (1 << 0)) {
-        unit = (MOUSEKEY_MOVE_DELTA * mk_max_speed) / 4;
+        unit = (delta * max_speed) / 4;
     } else if (mousekey_accel & (1 << 1)) {
-        unit = (MOUSEKEY_MOVE_DELTA * mk_max_speed) / 2;
+        unit = (delta * max_speed) / 2;
     } else if (mousekey_accel & (1 << 2)) {
-        unit = (MOUSEKEY_MOVE_DELTA * mk_max_speed);
-    } else if (mousekey_repeat == 0) {
-        unit = MOUSEKEY_MOVE_DELTA;
-    } else if (mousekey_repeat >= mk_time_to_max) {
-        unit = MOUSEKEY_MOVE_DELTA * mk_max_speed;
+        unit = (delta * max_speed);
     } else {
-        unit = (MOUSEKEY_MOVE_DELTA * mk_max_speed * mousekey_repeat) / mk_time_to_max;
+        unit = delta;
     }
-    return (unit > MOUSEKEY_MOVE_MAX ? MOUSEKEY_MOVE_MAX : (unit == 0 ? 1 : unit));
+    return (unit > max ? max : (unit == 0 ? 1 : unit));
 }
 
-static uint8_t wheel_unit(void) {
-    uint16_t unit;
+static uint8_t move_unit(void) { return unit_for(MOUSEKEY_MOVE_DELTA, mk_max_speed, MOUSEKEY_MOVE_MAX); }
+
+static uint8_t wheel_unit(void) { return unit_for(MOUSEKEY_WHEEL_DELTA, mk_wheel_max_speed, MOUSEKEY_WHEEL_MAX); }
+
+/*
+ * Speed in 1/256 units per interval, time ms after the initial delay.
+ * Accelerates linearly for time_to_max intervals, one step per interval
+ * into the ramp, up to delta * max_speed per interval, unless an
+ * acceleration key selects a fixed speed.
+ */
+static uint32_t motion_speed(uint32_t time, uint8_t delta, uint8_t max_speed, uint8_t time_to_max, uint8_t interval) {
+    uint32_t full = (uint32_t)delta * max_speed << 8;
     if (mousekey_accel & (1 << 0)) {
-        unit = (MOUSEKEY_WHEEL_DELTA * mk_wheel_max_speed) / 4;
+        return full / 4;
     } else if (mousekey_accel & (1 << 1)) {
-        unit = (MOUSEKEY_WHEEL_DELTA * mk_wheel_max_speed) / 2;
+        return full / 2;
     } else if (mousekey_accel & (1 << 2)) {
-        unit = (MOUSEKEY_WHEEL_DELTA * mk_wheel_max_speed);
-    } else if (mousekey_repeat == 0) {
-        unit = MOUSEKEY_WHEEL_DELTA;
-    } else if (mousekey_repeat >= mk_wheel_time_to_max) {
-        unit = MOUSEKEY_WHEEL_DELTA * mk_wheel_max_speed;
-    } else {
-        unit = (MOUSEKEY_WHEEL_DELTA * mk_wheel_max_speed * mousekey_repeat) / mk_wheel_time_to_max;
+        return full;
     }
-    return (unit > MOUSEKEY_WHEEL_MAX ? MOUSEKEY_WHEEL_MAX : (unit == 0 ? 1 : unit));
+
+    uint32_t ramp = (uint32_t)time_to_max * interval;
+    time += interval;
+    if (time < ramp) {
+        // split up so that it can't overflow
+        full = full / ramp * time + full % ramp * time / ramp;
+    }
+
+    // at least one unit per interval
+    return full > (1 << 8) ? full : (1 << 8);
 }
 
+/*
+ * Returns the whole units of movement since the last update, if it's time
+ * for one. diagonal scales the movement by 1/sqrt(2) for each axis.
+ */
+static uint8_t motion_update(mousekey_motion_t *motion, uint16_t delay, uint8_t delta, uint8_t max_speed, uint8_t time_to_max, uint8_t interval, uint8_t max, bool diagonal) {
+    uint32_t now = timer_read32();
+    if (TIMER_DIFF_32(now, motion->last) < MOUSEKEY_UPDATE_INTERVAL) {
+        return 0;
+    }
+
+    uint32_t from = TIMER_DIFF_32(motion->last, motion->start);
+    uint32_t to   = TIMER_DIFF_32(now, motion->start);
+    motion->last  = now;
+    if (to <= delay) {
+        return 0;
+    }
+    from = from > delay ? from - delay : 0;
+    to -= delay;
+    if (to - from > UINT8_MAX) {
+        // the task stalled, and the report can't hold more than max anyway
+        from = to - UINT8_MAX;
+    }
+    if (interval == 0) {
+        interval = 1;
+    }
+
+    // the speed ramps up linearly, so its value half way through is the average
+    uint32_t distance = motion_speed((from + to) / 2, delta, max_speed, time_to_max, interval) * (to - from) / interval;
+    if (diagonal) {
+        // scaled before the fraction is split off, so it goes into the carry
+        distance = ((uint64_t)distance * 181) >> 8;
+    }
+    distance += motion->carry;
+
+    uint32_t units = distance >> 8;
+    motion->carry  = distance & 0xFF;
+    return units > max ? max : units;
+}
+
+static void motion_start(mousekey_motion_t *motion) {
+    motion->start = timer_read32();
+    motion->last  = motion->start;
+    motion->carry = 0;
+}
+
+static int8_t axis_move(int8_t axis, uint8_t units) { return axis > 0 ? units : axis < 0 ? -units : 0; }
+
 void mousekey_task(void) {
     // report cursor and scroll movement independently
     report_mouse_t const tmpmr = mouse_report;
-    if ((mouse_report.x || mouse_report.y) && timer_elapsed(last_timer_c) > (mousekey_repeat ? mk_interval : mk_delay * 10)) {
-        if (mousekey_repeat != UINT8_MAX) mousekey_repeat++;
-        mouse_report.v = 0;
-        mouse_report.h = 0;
-        if (mouse_report.x > 0) mouse_report.x = move_unit();
-        if (mouse_report.x < 0) mouse_report.x = move_unit() * -1;
-        if (mouse_report.y > 0) mouse_report.y = move_unit();
-        if (mouse_report.y < 0) mouse_report.y = move_unit() * -1;
-        /* diagonal move [1/sqrt(2)] */
-        if (mouse_report.x && mouse_report.y) {
-            mouse_report.x = times_inv_sqrt2(mouse_report.x);
-            if (mouse_report.x == 0) {
-                mouse_report.x = 1;
-            }
-            mouse_report.y = times_inv_sqrt2(mouse_report.y);
-            if (mouse_report.y == 0) {
-                mouse_report.y = 1;
-            }
+    if (mouse_report.x || mouse_report.y) {
+        uint8_t units = motion_update(&cursor, mk_delay * 10, MOUSEKEY_MOVE_DELTA, mk_max_speed, mk_time_to_max, mk_interval, MOUSEKEY_MOVE_MAX, mouse_report.x && mouse_report.y);
+        if (units) {
+            mouse_report.x = axis_move(mouse_report.x, units);
+            mouse_report.y = axis_move(mouse_report.y, units);
+            mouse_report.v = 0;
+            mouse_report.h = 0;
+            mousekey_send();
+            mouse_report = tmpmr;
         }
-        mousekey_send();
-        last_timer_c = last_timer;
-        mouse_report = tmpmr;
     }
-    if ((mouse_report.v || mouse_report.h) && timer_elapsed(last_timer_w) > (mousekey_repeat ? mk_wheel_interval : mk_wheel_delay * 10)) {
-        if (mousekey_repeat != UINT8_MAX) mousekey_repeat++;
-        mouse_report.x = 0;
-        mouse_report.y = 0;
-        if (mouse_report.v > 0) mouse_report.v = wheel_unit();
-        if (mouse_report.v < 0) mouse_report.v = wheel_unit() * -1;
-        if (mouse_report.h > 0) mouse_report.h = wheel_unit();
-        if (mouse_report.h < 0) mouse_report.h = wheel_unit() * -1;
-        /* diagonal move [1/sqrt(2)] */
-        if (mouse_report.v && mouse_report.h) {
-            mouse_report.v = times_inv_sqrt2(mouse_report.v);
-            if (mouse_report.v == 0) {
-                mouse_report.v = 1;
-            }
-            mouse_report.h = times_inv_sqrt2(mouse_report.h);
-            if (mouse_report.h == 0) {
-                mouse_report.h = 1;
-            }
+    if (mouse_report.v || mouse_report.h) {
+        uint8_t units = motion_update(&wheel, mk_wheel_delay * 10, MOUSEKEY_WHEEL_DELTA, mk_wheel_max_speed, mk_wheel_time_to_max, mk_wheel_interval, MOUSEKEY_WHEEL_MAX, mouse_report.v && mouse_report.h);
+        if (units) {
+            mouse_report.x = 0;
+            mouse_report.y = 0;
+            mouse_report.v = axis_move(mouse_report.v, units);
+            mouse_report.h = axis_move(mouse_report.h, units);
+            mousekey_send();
+            mouse_report = tmpmr;
         }
-        mousekey_send();
-        last_timer_w = last_timer;
-        mouse_report = tmpmr;
     }
 }
 
 void mousekey_on(uint8_t code) {
+    // the first direction key pressed starts the acceleration from scratch
+    if ((code == KC_MS_UP || code == KC_MS_DOWN || code == KC_MS_LEFT || code == KC_MS_RIGHT) && !mouse_report.x && !mouse_report.y) {
+        motion_start(&cursor);
+    }
+    if ((code == KC_MS_WH_UP || code == KC_MS_WH_DOWN || code == KC_MS_WH_LEFT || code == KC_MS_WH_RIGHT) && !mouse_report.v && !mouse_report.h) {
+        motion_start(&wheel);
+    }
+
     if (code == KC_MS_UP)
         mouse_report.y = move_unit() * -1;
     else if (code == KC_MS_DOWN)
@@ -221,7 +271,6 @@ void mousekey_off(uint8_t code) {
         mousekey_accel &= ~(1 << 1);
     else if (code == KC_MS_ACCEL2)
         mousekey_accel &= ~(1 << 2);
-    if (mouse_report.x == 0 && mouse_report.y == 0 && mouse_report.v == 0 && mouse_report.h == 0) mousekey_repeat = 0;
 }
 
 #else /* #ifndef MK_3_SPEED */
@@ -376,14 +425,13 @@ void mousekey_send(void) {
 }
 
 void mousekey_clear(void) {
-    mouse_report    = (report_mouse_t){};
-    mousekey_repeat = 0;
-    mousekey_accel  = 0;
+    mouse_report   = (report_mouse_t){};
+    mousekey_accel = 0;
 }
 
 static void mousekey_debug(void) {
     if (!debug_mouse) return;
-    print("mousekey [btn|x y v h](rep/acl): [");
+    print("mousekey [btn|x y v h](acl): [");
     phex(mouse_report.buttons);
     print("|");
     print_decs(mouse_report.x);
@@ -394,8 +442,6 @@ static void mousekey_debug(void) {
     print(" ");
     print_decs(mouse_report.h);
     print("](");
-    print_dec(mousekey_repeat);
-    print("/");
     print_dec(mousekey_accel);
     print(")\n");
 }
@@ -67,6 +67,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #    ifndef MOUSEKEY_WHEEL_TIME_TO_MAX
 #        define MOUSEKEY_WHEEL_TIME_TO_MAX 40
 #    endif
+/* milliseconds between reports while a key is held, movement in between is carried over */
+#    ifndef MOUSEKEY_UPDATE_INTERVAL
+#        define MOUSEKEY_UPDATE_INTERVAL 8
+#    endif
 
 #else /* #ifndef MK_3_SPEED */
 
@@ -104,6 +104,9 @@ enum desktop_usages {
 #        define KEYBOARD_REPORT_BITS (NKRO_EPSIZE - 1)
 #        undef NKRO_SHARED_EP
 #        undef MOUSE_SHARED_EP
+#    elif defined(PROTOCOL_SIMULATOR)
+// Same as a 32 byte shared endpoint on LUFA and ChibiOS
+#        define KEYBOARD_REPORT_BITS 30
 #    else
 #        error "NKRO not supported with this protocol"
 #    endif
@@ -123,6 +126,11 @@ enum desktop_usages {
 #    undef MOUSE_SHARED_EP
 #endif
 
+/* 16-bit X/Y movement needs the report descriptor from usb_descriptor.c */
+#if defined(MOUSE_EXTENDED_REPORT) && (defined(PROTOCOL_VUSB) || defined(PROTOCOL_ARM_ATSAM))
+#    error "MOUSE_EXTENDED_REPORT is only supported with LUFA and ChibiOS"
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -173,15 +181,23 @@ typedef struct {
     uint16_t usage;
 } __attribute__((packed)) report_extra_t;
 
+#ifdef MOUSE_EXTENDED_REPORT
+typedef int16_t mouse_xy_report_t;
+#    define MOUSE_XY_REPORT_MAX 32767
+#else
+typedef int8_t mouse_xy_report_t;
+#    define MOUSE_XY_REPORT_MAX 127
+#endif
+
 typedef struct {
 #ifdef MOUSE_SHARED_EP
     uint8_t report_id;
 #endif
-    uint8_t buttons;
-    int8_t  x;
-    int8_t  y;
-    int8_t  v;
-    int8_t  h;
+    uint8_t           buttons;
+    mouse_xy_report_t x;
+    mouse_xy_report_t y;
+    int8_t            v;
+    int8_t            h;
 } __attribute__((packed)) report_mouse_t;
 
 /* keycode to system usage */
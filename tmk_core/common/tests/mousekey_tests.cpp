@@ -0,0 +1,251 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include <vector>
+extern "C" {
+#include "keycode.h"
+#include "debug.h"
+#include "mousekey.h"
+
+void set_time(uint32_t t);
+void advance_time(uint32_t ms);
+}
+
+static std::vector<report_mouse_t> reports;
+
+extern "C" {
+debug_config_t debug_config;
+
+void host_mouse_send(report_mouse_t *report) { reports.push_back(*report); }
+}
+
+class Mousekey : public testing::Test {
+   public:
+    Mousekey() {
+        set_time(0);
+        reports.clear();
+        mousekey_clear();
+        mk_delay             = MOUSEKEY_DELAY / 10;
+        mk_interval          = MOUSEKEY_INTERVAL;
+        mk_max_speed         = MOUSEKEY_MAX_SPEED;
+        mk_time_to_max       = MOUSEKEY_TIME_TO_MAX;
+        mk_wheel_max_speed   = MOUSEKEY_WHEEL_MAX_SPEED;
+        mk_wheel_time_to_max = MOUSEKEY_WHEEL_TIME_TO_MAX;
+    }
+
+    // The same as action.c does for mouse keys
+    void press(uint8_t code) {
+        mousekey_on(code);
+        mousekey_send();
+    }
+
+    void release(uint8_t code) {
+        mousekey_off(code);
+        mousekey_send();
+    }
+
+    // Runs the task every step ms for time ms
+    void run(uint32_t time, uint32_t step = 1) {
+        for (uint32_t elapsed = 0; elapsed < time; elapsed += step) {
+            advance_time(step);
+            mousekey_task();
+        }
+    }
+
+    int total_x() {
+        int x = 0;
+        for (auto &report : reports) {
+            x += report.x;
+        }
+        return x;
+    }
+};
+
+TEST_F(Mousekey, moves_once_on_press) {
+    press(KC_MS_RIGHT);
+    ASSERT_EQ(reports.size(), 1);
+    EXPECT_EQ(reports[0].x, MOUSEKEY_MOVE_DELTA);
+    EXPECT_EQ(reports[0].y, 0);
+
+    run(MOUSEKEY_DELAY);
+    EXPECT_EQ(reports.size(), 1);
+}
+
+TEST_F(Mousekey, accelerates_to_max_speed) {
+    press(KC_MS_DOWN);
+    run(MOUSEKEY_DELAY);
+
+    // Distance moved every four intervals, until some time after reaching max speed
+    std::vector<int> distances;
+    for (int i = 0; i < MOUSEKEY_TIME_TO_MAX / 4 + 2; i++) {
+        size_t first = reports.size();
+        run(MOUSEKEY_INTERVAL * 4);
+        int distance = 0;
+        for (size_t j = first; j < reports.size(); j++) {
+            EXPECT_EQ(reports[j].x, 0);
+            EXPECT_GT(reports[j].y, 0);
+            distance += reports[j].y;
+        }
+        distances.push_back(distance);
+    }
+
+    // Within the movement of one update, as they don't line up with the intervals
+    const int max_speed = MOUSEKEY_MOVE_DELTA * MOUSEKEY_MAX_SPEED;
+    const int tolerance = max_speed * MOUSEKEY_UPDATE_INTERVAL / MOUSEKEY_INTERVAL;
+    EXPECT_NEAR(distances[0], max_speed * (1 + 2 + 3 + 4) / MOUSEKEY_TIME_TO_MAX, tolerance);
+    for (size_t i = 1; i < distances.size(); i++) {
+        EXPECT_GT(distances[i] + tolerance, distances[i - 1]);
+    }
+    EXPECT_NEAR(distances.back(), max_speed * 4, tolerance);
+}
+
+TEST_F(Mousekey, distance_does_not_depend_on_task_rate) {
+    std::vector<int> totals;
+    for (uint32_t step : {1, 3, 7, 16}) {
+        set_time(0);
+        reports.clear();
+        press(KC_MS_RIGHT);
+        run(2000, step);
+        release(KC_MS_RIGHT);
+        totals.push_back(total_x());
+    }
+
+    for (size_t i = 1; i < totals.size(); i++) {
+        EXPECT_NEAR(totals[i], totals[0], 2);
+    }
+}
+
+TEST_F(Mousekey, carries_fractions_over) {
+    // Less than one unit per update: the wheel starts at one step per interval
+    press(KC_MS_WH_UP);
+    reports.clear();
+    run(MOUSEKEY_WHEEL_DELAY);
+    run(MOUSEKEY_WHEEL_INTERVAL * 4);
+
+    int steps = 0;
+    for (auto &report : reports) {
+        EXPECT_EQ(report.v, 1);
+        steps += report.v;
+    }
+    // The ramp only gets past the slowest speed after a few intervals
+    EXPECT_GE(steps, 3);
+    EXPECT_LE(steps, 4);
+}
+
+TEST_F(Mousekey, moves_at_max_speed_without_acceleration) {
+    mk_time_to_max = 0;
+    press(KC_MS_LEFT);
+    reports.clear();
+    run(MOUSEKEY_DELAY + 1000);
+
+    const int max_speed = MOUSEKEY_MOVE_DELTA * MOUSEKEY_MAX_SPEED;
+    EXPECT_NEAR(reports.size(), 1000 / MOUSEKEY_UPDATE_INTERVAL, 1);
+    EXPECT_NEAR(total_x(), -1000 * max_speed / MOUSEKEY_INTERVAL, max_speed * MOUSEKEY_UPDATE_INTERVAL / MOUSEKEY_INTERVAL);
+}
+
+TEST_F(Mousekey, accel_keys_select_fixed_speed) {
+    press(KC_MS_ACCEL1);
+    press(KC_MS_RIGHT);
+    reports.clear();
+    run(MOUSEKEY_DELAY + 1000);
+
+    const int speed = MOUSEKEY_MOVE_DELTA * MOUSEKEY_MAX_SPEED / 2;
+    EXPECT_NEAR(total_x(), 1000 * speed / MOUSEKEY_INTERVAL, speed * MOUSEKEY_UPDATE_INTERVAL / MOUSEKEY_INTERVAL);
+}
+
+TEST_F(Mousekey, scales_diagonals) {
+    mk_time_to_max = 0;
+    press(KC_MS_RIGHT);
+    press(KC_MS_DOWN);
+    reports.clear();
+    run(MOUSEKEY_DELAY + 1000);
+
+    int x = 0, y = 0;
+    for (auto &report : reports) {
+        EXPECT_EQ(report.x, report.y);
+        x += report.x;
+        y += report.y;
+    }
+    const int max_speed = MOUSEKEY_MOVE_DELTA * MOUSEKEY_MAX_SPEED;
+    EXPECT_NEAR(x, 1000 * max_speed / MOUSEKEY_INTERVAL * 181 / 256, max_speed * MOUSEKEY_UPDATE_INTERVAL / MOUSEKEY_INTERVAL);
+}
+
+TEST_F(Mousekey, scales_diagonals_while_accelerating) {
+    press(KC_MS_RIGHT);
+    reports.clear();
+    run(MOUSEKEY_DELAY + 300);
+    int straight = total_x();
+    release(KC_MS_RIGHT);
+
+    press(KC_MS_RIGHT);
+    press(KC_MS_DOWN);
+    reports.clear();
+    run(MOUSEKEY_DELAY + 300);
+    const int tolerance = MOUSEKEY_MOVE_DELTA * MOUSEKEY_MAX_SPEED * MOUSEKEY_UPDATE_INTERVAL / MOUSEKEY_INTERVAL;
+    EXPECT_NEAR(total_x(), straight * 181 / 256, tolerance);
+}
+
+TEST_F(Mousekey, scrolls_diagonally) {
+    press(KC_MS_WH_UP);
+    reports.clear();
+    run(5000);
+    int straight = 0;
+    for (auto &report : reports) {
+        straight += report.v;
+    }
+    release(KC_MS_WH_UP);
+
+    // Each step is less than a unit, the fractions have to add up
+    press(KC_MS_WH_UP);
+    press(KC_MS_WH_RIGHT);
+    reports.clear();
+    run(5000);
+    int v = 0, h = 0;
+    for (auto &report : reports) {
+        EXPECT_EQ(report.v, report.h);
+        v += report.v;
+        h += report.h;
+    }
+    EXPECT_GT(straight, 0);
+    EXPECT_NEAR(v, straight * 181 / 256, 2);
+    EXPECT_EQ(h, v);
+}
+
+TEST_F(Mousekey, stops_on_release) {
+    press(KC_MS_UP);
+    run(MOUSEKEY_DELAY + 500);
+    release(KC_MS_UP);
+    EXPECT_EQ(reports.back().y, 0);
+
+    size_t count = reports.size();
+    run(1000);
+    EXPECT_EQ(reports.size(), count);
+}
+
+TEST_F(Mousekey, restarts_acceleration_on_next_press) {
+    press(KC_MS_RIGHT);
+    reports.clear();
+    run(MOUSEKEY_DELAY + 400);
+    int first = total_x();
+    run(2000);
+    release(KC_MS_RIGHT);
+
+    press(KC_MS_RIGHT);
+    reports.clear();
+    run(MOUSEKEY_DELAY + 400);
+    EXPECT_EQ(total_x(), first);
+}
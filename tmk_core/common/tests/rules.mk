@@ -0,0 +1,6 @@
+mousekey_SRC :=\
+	$(TMK_PATH)/common/tests/mousekey_tests.cpp \
+	$(TMK_PATH)/common/mousekey.c \
+	$(TMK_PATH)/common/test/timer.c
+
+mousekey_DEFS := -DNO_PRINT -DNO_DEBUG
@@ -7,4 +7,7 @@ void virtser_recv(const uint8_t ch);
 /* Call this to send a character over the Virtual Serial Device */
 void virtser_send(const uint8_t byte);
 
+/* Call this to send several characters at once, in as few packets as possible */
+void virtser_send_buffer(const uint8_t *data, uint8_t length);
+
 #endif
@@ -0,0 +1,79 @@
+#!/bin/sh
+# Compiles a C or C++ file through a cache of objects shared by every build,
+# used when OBJ_CACHE = yes.
+#
+#   objcache.sh <cache dir> <stats file> <compiler.txt> <object> <source> <dep file> <compiler> <flags...>
+#
+# An object is looked up by the hash of the preprocessed source, the compiler
+# version and the flags that aren't only for the preprocessor. Paths of the
+# include folders and of config.h differ between keymaps, but once they have
+# been preprocessed only their contents matter, so keymaps that end up with the
+# same source share the object.
+#
+# Each lookup appends "hit" or "miss" to the stats file.
+
+CACHE_DIR=$1
+STATS=$2
+COMPILER_VERSION=$3
+OBJECT=$4
+SOURCE=$5
+DEPFILE=$6
+shift 6
+
+if command -v sha1sum > /dev/null 2>&1; then
+    HASH=sha1sum
+else
+    HASH=shasum
+fi
+
+# The flags that change the object once the source is preprocessed
+KEY_FLAGS=
+SKIP_NEXT=
+for FLAG in "$@"; do
+    if [ -n "$SKIP_NEXT" ]; then
+        SKIP_NEXT=
+        continue
+    fi
+    case "$FLAG" in
+        -include) SKIP_NEXT=yes ;;
+        -I*|-D*|-U*|-Wa,-adhlns=*) ;;
+        *) KEY_FLAGS="$KEY_FLAGS $FLAG" ;;
+    esac
+done
+
+# The dependencies are written while preprocessing, as they differ between
+# keymaps even when the object doesn't. Without line markers the output only
+# depends on what the headers contain, not where they are.
+PREPROCESSED=${OBJECT%.o}.i
+if ! "$@" -E -P -MMD -MP -MF "$DEPFILE" -MT "$OBJECT" "$SOURCE" -o "$PREPROCESSED" 2> /dev/null; then
+    # Let the compiler report the error
+    rm -f "$PREPROCESSED"
+    "$@" -c -MMD -MP -MF "$DEPFILE" "$SOURCE" -o "$OBJECT"
+    exit $?
+fi
+
+KEY=$( (cat "$PREPROCESSED" "$COMPILER_VERSION"; echo "$KEY_FLAGS") | $HASH | cut -c1-40)
+rm -f "$PREPROCESSED"
+
+if [ -f "$CACHE_DIR/$KEY.o" ]; then
+    cp "$CACHE_DIR/$KEY.o" "$OBJECT" || exit 1
+    # Warnings are shown again, as if it had been compiled
+    if [ -s "$CACHE_DIR/$KEY.log" ]; then
+        cat "$CACHE_DIR/$KEY.log" >&2
+    fi
+    echo hit >> "$STATS"
+    exit 0
+fi
+
+"$@" -c "$SOURCE" -o "$OBJECT" 2> "$OBJECT.log"
+STATUS=$?
+cat "$OBJECT.log" >&2
+if [ $STATUS -eq 0 ]; then
+    # Renamed into place, so parallel builds never see half a file
+    mkdir -p "$CACHE_DIR"
+    cp "$OBJECT.log" "$CACHE_DIR/$KEY.log.$$" && mv -f "$CACHE_DIR/$KEY.log.$$" "$CACHE_DIR/$KEY.log"
+    cp "$OBJECT" "$CACHE_DIR/$KEY.o.$$" && mv -f "$CACHE_DIR/$KEY.o.$$" "$CACHE_DIR/$KEY.o"
+    echo miss >> "$STATS"
+fi
+rm -f "$OBJECT.log"
+exit $STATUS
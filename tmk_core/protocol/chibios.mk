@@ -3,6 +3,7 @@ CHIBIOS_DIR = $(PROTOCOL_DIR)/chibios
 
 
 SRC += $(CHIBIOS_DIR)/usb_main.c
+SRC += report_queue.c
 SRC += $(CHIBIOS_DIR)/main.c
 SRC += usb_descriptor.c
 SRC += $(CHIBIOS_DIR)/usb_driver.c
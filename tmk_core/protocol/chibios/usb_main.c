@@ -29,6 +29,7 @@
 #include "hal.h"
 
 #include "usb_main.h"
+#include "report_queue.h"
 
 #include "host.h"
 #include "debug.h"
@@ -161,6 +162,27 @@ static const USBEndpointConfig shared_ep_config = {
 };
 #endif
 
+/* Reports waiting to go IN, one queue per HID endpoint.
+ * Filled by the send_* functions, drained by the IN callbacks. */
+#ifndef KEYBOARD_SHARED_EP
+static report_queue_t kbd_report_queue;
+#    define KEYBOARD_REPORT_QUEUE (&kbd_report_queue)
+#else
+#    define KEYBOARD_REPORT_QUEUE (&shared_report_queue)
+#endif
+#if defined(MOUSE_ENABLE) && !defined(MOUSE_SHARED_EP)
+static report_queue_t mouse_report_queue;
+#    define MOUSE_REPORT_QUEUE (&mouse_report_queue)
+#else
+#    define MOUSE_REPORT_QUEUE (&shared_report_queue)
+#endif
+#ifdef SHARED_EP_ENABLE
+static report_queue_t shared_report_queue;
+#    if REPORT_QUEUE_REPORT_SIZE < SHARED_EPSIZE
+#        error "REPORT_QUEUE_REPORT_SIZE is too small for the shared endpoint"
+#    endif
+#endif
+
 typedef struct {
     size_t              queue_capacity_in;
     size_t              queue_capacity_out;
@@ -310,6 +332,16 @@ static void usb_event_cb(USBDriver *usbp, usbevent_t event) {
 #endif
 #ifdef SHARED_EP_ENABLE
             usbInitEndpointI(usbp, SHARED_IN_EPNUM, &shared_ep_config);
+#endif
+            /* Reports queued before a reset will never complete */
+#ifndef KEYBOARD_SHARED_EP
+            report_queue_clear(&kbd_report_queue);
+#endif
+#if defined(MOUSE_ENABLE) && !defined(MOUSE_SHARED_EP)
+            report_queue_clear(&mouse_report_queue);
+#endif
+#ifdef SHARED_EP_ENABLE
+            report_queue_clear(&shared_report_queue);
 #endif
             for (int i = 0; i < NUM_USB_DRIVERS; i++) {
                 usbInitEndpointI(usbp, drivers.array[i].config.bulk_in, &drivers.array[i].in_ep_config);
@@ -559,17 +591,113 @@ void init_usb_driver(USBDriver *usbp) {
     chVTObjectInit(&keyboard_idle_timer);
 }
 
+/* ---------------------------------------------------------
+ *                  Report queue functions
+ * ---------------------------------------------------------
+ */
+
+/* start sending the next queued report, unless the endpoint is busy
+ * (with our previous report, or with an idle report)
+ * called from locked state */
+static bool transmit_next_reportI(USBDriver *usbp, usbep_t ep, report_queue_t *queue) {
+    if (usbGetTransmitStatusI(usbp, ep)) {
+        return false;
+    }
+
+    const report_queue_entry_t *entry = report_queue_start(queue);
+    if (entry == NULL) {
+        return false;
+    }
+    usbStartTransmitI(usbp, ep, entry->data, entry->length);
+    return true;
+}
+
+/* The host polling interval is measured on the keyboard endpoint: a report
+ * started right as the previous one went IN goes IN on the next poll. */
+static usbep_t       polling_ep;
+static systime_t     polling_start;
+static sysinterval_t polling_interval;
+
+static usbep_t keyboard_report_ep(void) {
+#ifdef NKRO_ENABLE
+    if (keymap_config.nkro && keyboard_protocol) {
+        return SHARED_IN_EPNUM;
+    }
+#endif
+    return KEYBOARD_IN_EPNUM;
+}
+
+uint32_t host_polling_interval_us(void) {
+    if (polling_interval == 0) {
+        /* no back to back reports yet, report what the descriptor asks for */
+#ifdef NKRO_ENABLE
+        if (keymap_config.nkro && keyboard_protocol) {
+            return USB_POLLING_INTERVAL_US(USB_POLLING_INTERVAL(SHARED_POLLING_INTERVAL_MS));
+        }
+#endif
+        return USB_POLLING_INTERVAL_US(USB_POLLING_INTERVAL(KEYBOARD_POLLING_INTERVAL_MS));
+    }
+    return TIME_I2US(polling_interval);
+}
+
+/* IN callback handler shared by the HID endpoints (a queued report has made it IN)
+ * called from ISR, unlocked state */
+static void report_sent_cb(USBDriver *usbp, usbep_t ep, report_queue_t *queue) {
+    osalSysLockFromISR();
+    systime_t now = chVTGetSystemTimeX();
+    if (polling_ep == ep) {
+        polling_interval = (sysinterval_t)(now - polling_start);
+        polling_ep       = 0;
+    }
+
+    report_queue_complete(queue);
+    if (transmit_next_reportI(usbp, ep, queue) && ep == keyboard_report_ep()) {
+        polling_ep    = ep;
+        polling_start = now;
+    }
+    osalSysUnlockFromISR();
+}
+
+/* queue a report and return, the IN callback sends it once the ones before it are through
+ * not callable from ISR or locked state */
+static void send_report(usbep_t ep, report_queue_t *queue, const void *report, uint8_t length, sysinterval_t timeout) {
+    if (usbGetDriverStateI(&USB_DRIVER) != USB_ACTIVE) {
+        return;
+    }
+
+    /* the producer side of the queue doesn't need the lock */
+    bool queued = report_queue_push(queue, report, length);
+
+    osalSysLock();
+    /* The queue only fills up when the host stops polling the endpoint, wait
+     * for a report to go through then. The endpoint thread reference is
+     * resumed after every IN callback (needs USB_USE_WAIT == TRUE). */
+    while (!queued) {
+        if (osalThreadSuspendTimeoutS(&(&USB_DRIVER)->epc[ep]->in_state->thread, timeout) == MSG_TIMEOUT) {
+            goto unlock;
+        }
+        /* after osalThreadSuspendTimeoutS returns USB status might have changed */
+        if (usbGetDriverStateI(&USB_DRIVER) != USB_ACTIVE) {
+            goto unlock;
+        }
+        queued = report_queue_push(queue, report, length);
+    }
+
+    if (usbGetDriverStateI(&USB_DRIVER) == USB_ACTIVE) {
+        transmit_next_reportI(&USB_DRIVER, ep, queue);
+    }
+
+unlock:
+    osalSysUnlock();
+}
+
 /* ---------------------------------------------------------
  *                  Keyboard functions
  * ---------------------------------------------------------
  */
 /* keyboard IN callback hander (a kbd report has made it IN) */
 #ifndef KEYBOARD_SHARED_EP
-void kbd_in_cb(USBDriver *usbp, usbep_t ep) {
-    /* STUB */
-    (void)usbp;
-    (void)ep;
-}
+void kbd_in_cb(USBDriver *usbp, usbep_t ep) { report_sent_cb(usbp, ep, &kbd_report_queue); }
 #endif
 
 /* start-of-frame handler
@@ -612,51 +740,15 @@ static void keyboard_idle_timer_cb(void *arg) {
 /* LED status */
 uint8_t keyboard_leds(void) { return keyboard_led_stats; }
 
-/* prepare and start sending a report IN
+/* queue a report to go IN
  * not callable from ISR or locked state */
 void send_keyboard(report_keyboard_t *report) {
-    osalSysLock();
-    if (usbGetDriverStateI(&USB_DRIVER) != USB_ACTIVE) {
-        goto unlock;
-    }
-
 #ifdef NKRO_ENABLE
     if (keymap_config.nkro && keyboard_protocol) { /* NKRO protocol */
-        /* need to wait until the previous packet has made it through */
-        /* can rewrite this using the synchronous API, then would wait
-         * until *after* the packet has been transmitted. I think
-         * this is more efficient */
-        /* busy wait, should be short and not very common */
-        if (usbGetTransmitStatusI(&USB_DRIVER, SHARED_IN_EPNUM)) {
-            /* Need to either suspend, or loop and call unlock/lock during
-             * every iteration - otherwise the system will remain locked,
-             * no interrupts served, so USB not going through as well.
-             * Note: for suspend, need USB_USE_WAIT == TRUE in halconf.h */
-            osalThreadSuspendS(&(&USB_DRIVER)->epc[SHARED_IN_EPNUM]->in_state->thread);
-
-            /* after osalThreadSuspendS returns USB status might have changed */
-            if (usbGetDriverStateI(&USB_DRIVER) != USB_ACTIVE) {
-                goto unlock;
-            }
-        }
-        usbStartTransmitI(&USB_DRIVER, SHARED_IN_EPNUM, (uint8_t *)report, sizeof(struct nkro_report));
+        send_report(SHARED_IN_EPNUM, &shared_report_queue, report, sizeof(struct nkro_report), TIME_INFINITE);
     } else
 #endif /* NKRO_ENABLE */
     {  /* regular protocol */
-        /* need to wait until the previous packet has made it through */
-        /* busy wait, should be short and not very common */
-        if (usbGetTransmitStatusI(&USB_DRIVER, KEYBOARD_IN_EPNUM)) {
-            /* Need to either suspend, or loop and call unlock/lock during
-             * every iteration - otherwise the system will remain locked,
-             * no interrupts served, so USB not going through as well.
-             * Note: for suspend, need USB_USE_WAIT == TRUE in halconf.h */
-            osalThreadSuspendS(&(&USB_DRIVER)->epc[KEYBOARD_IN_EPNUM]->in_state->thread);
-
-            /* after osalThreadSuspendS returns USB status might have changed */
-            if (usbGetDriverStateI(&USB_DRIVER) != USB_ACTIVE) {
-                goto unlock;
-            }
-        }
         uint8_t *data, size;
         if (keyboard_protocol) {
             data = (uint8_t *)report;
@@ -665,12 +757,9 @@ void send_keyboard(report_keyboard_t *report) {
             data = &report->mods;
             size = 8;
         }
-        usbStartTransmitI(&USB_DRIVER, KEYBOARD_IN_EPNUM, data, size);
+        send_report(KEYBOARD_IN_EPNUM, KEYBOARD_REPORT_QUEUE, data, size, TIME_INFINITE);
     }
     keyboard_report_sent = *report;
-
-unlock:
-    osalSysUnlock();
 }
 
 /* ---------------------------------------------------------
@@ -682,32 +771,10 @@ unlock:
 
 #    ifndef MOUSE_SHARED_EP
 /* mouse IN callback hander (a mouse report has made it IN) */
-void mouse_in_cb(USBDriver *usbp, usbep_t ep) {
-    (void)usbp;
-    (void)ep;
-}
+void mouse_in_cb(USBDriver *usbp, usbep_t ep) { report_sent_cb(usbp, ep, &mouse_report_queue); }
 #    endif
 
-void send_mouse(report_mouse_t *report) {
-    osalSysLock();
-    if (usbGetDriverStateI(&USB_DRIVER) != USB_ACTIVE) {
-        osalSysUnlock();
-        return;
-    }
-
-    if (usbGetTransmitStatusI(&USB_DRIVER, MOUSE_IN_EPNUM)) {
-        /* Need to either suspend, or loop and call unlock/lock during
-         * every iteration - otherwise the system will remain locked,
-         * no interrupts served, so USB not going through as well.
-         * Note: for suspend, need USB_USE_WAIT == TRUE in halconf.h */
-        if (osalThreadSuspendTimeoutS(&(&USB_DRIVER)->epc[MOUSE_IN_EPNUM]->in_state->thread, TIME_MS2I(10)) == MSG_TIMEOUT) {
-            osalSysUnlock();
-            return;
-        }
-    }
-    usbStartTransmitI(&USB_DRIVER, MOUSE_IN_EPNUM, (uint8_t *)report, sizeof(report_mouse_t));
-    osalSysUnlock();
-}
+void send_mouse(report_mouse_t *report) { send_report(MOUSE_IN_EPNUM, MOUSE_REPORT_QUEUE, report, sizeof(report_mouse_t), TIME_MS2I(USB_REPORT_SEND_TIMEOUT_MS(MOUSE_POLLING_INTERVAL_MS))); }
 
 #else  /* MOUSE_ENABLE */
 void send_mouse(report_mouse_t *report) { (void)report; }
@@ -719,11 +786,7 @@ void send_mouse(report_mouse_t *report) { (void)report; }
  */
 #ifdef SHARED_EP_ENABLE
 /* shared IN callback hander */
-void shared_in_cb(USBDriver *usbp, usbep_t ep) {
-    /* STUB */
-    (void)usbp;
-    (void)ep;
-}
+void shared_in_cb(USBDriver *usbp, usbep_t ep) { report_sent_cb(usbp, ep, &shared_report_queue); }
 #endif
 
 /* ---------------------------------------------------------
@@ -733,16 +796,9 @@ void shared_in_cb(USBDriver *usbp, usbep_t ep) {
 
 #ifdef EXTRAKEY_ENABLE
 static void send_extra(uint8_t report_id, uint16_t data) {
-    osalSysLock();
-    if (usbGetDriverStateI(&USB_DRIVER) != USB_ACTIVE) {
-        osalSysUnlock();
-        return;
-    }
-
     report_extra_t report = {.report_id = report_id, .usage = data};
 
-    usbStartTransmitI(&USB_DRIVER, SHARED_IN_EPNUM, (uint8_t *)&report, sizeof(report_extra_t));
-    osalSysUnlock();
+    send_report(SHARED_IN_EPNUM, &shared_report_queue, &report, sizeof(report_extra_t), TIME_INFINITE);
 }
 #endif
 
@@ -854,6 +910,8 @@ void midi_ep_task(void) {
 
 void virtser_send(const uint8_t byte) { chnWrite(&drivers.serial_driver.driver, &byte, 1); }
 
+void virtser_send_buffer(const uint8_t *data, uint8_t length) { chnWrite(&drivers.serial_driver.driver, data, length); }
+
 __attribute__((weak)) void virtser_recv(uint8_t c) {
     // Ignore by default
 }
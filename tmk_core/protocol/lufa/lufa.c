@@ -92,6 +92,9 @@ static uint8_t keyboard_led_stats = 0;
 
 static report_keyboard_t keyboard_report_sent;
 
+/* How long to wait for an endpoint to take a report, in 40us steps */
+#define REPORT_SEND_TIMEOUT(interval_ms) ((uint16_t)(USB_REPORT_SEND_TIMEOUT_MS(interval_ms) * 1000UL / 40))
+
 /* Host driver */
 static uint8_t keyboard_leds(void);
 static void    send_keyboard(report_keyboard_t *report);
@@ -547,13 +550,26 @@ void EVENT_USB_Device_ControlRequest(void) {
  */
 static uint8_t keyboard_leds(void) { return keyboard_led_stats; }
 
+/** \brief Polling Interval
+ *
+ * The interval the keyboard endpoint descriptor asks the host for.
+ */
+uint32_t host_polling_interval_us(void) {
+#ifdef NKRO_ENABLE
+    if (keyboard_protocol && keymap_config.nkro) {
+        return USB_POLLING_INTERVAL_US(USB_POLLING_INTERVAL(SHARED_POLLING_INTERVAL_MS));
+    }
+#endif
+    return USB_POLLING_INTERVAL_US(USB_POLLING_INTERVAL(KEYBOARD_POLLING_INTERVAL_MS));
+}
+
 /** \brief Send Keyboard
  *
  * FIXME: Needs doc
  */
 static void send_keyboard(report_keyboard_t *report) {
-    uint8_t timeout = 255;
-    uint8_t where   = where_to_send();
+    uint16_t timeout = REPORT_SEND_TIMEOUT(KEYBOARD_POLLING_INTERVAL_MS);
+    uint8_t  where   = where_to_send();
 
 #ifdef BLUETOOTH_ENABLE
     if (where == OUTPUT_BLUETOOTH || where == OUTPUT_USB_AND_BT) {
@@ -588,12 +604,13 @@ static void send_keyboard(report_keyboard_t *report) {
     uint8_t size = KEYBOARD_REPORT_SIZE;
 #ifdef NKRO_ENABLE
     if (keyboard_protocol && keymap_config.nkro) {
-        ep   = SHARED_IN_EPNUM;
-        size = sizeof(struct nkro_report);
+        ep      = SHARED_IN_EPNUM;
+        size    = sizeof(struct nkro_report);
+        timeout = REPORT_SEND_TIMEOUT(SHARED_POLLING_INTERVAL_MS);
     }
 #endif
     Endpoint_SelectEndpoint(ep);
-    /* Check if write ready for a polling interval around 10ms */
+    /* Check if write ready within the polling interval */
     while (timeout-- && !Endpoint_IsReadWriteAllowed()) _delay_us(40);
     if (!Endpoint_IsReadWriteAllowed()) return;
 
@@ -616,8 +633,8 @@ static void send_keyboard(report_keyboard_t *report) {
  */
 static void send_mouse(report_mouse_t *report) {
 #ifdef MOUSE_ENABLE
-    uint8_t timeout = 255;
-    uint8_t where   = where_to_send();
+    uint16_t timeout = REPORT_SEND_TIMEOUT(MOUSE_POLLING_INTERVAL_MS);
+    uint8_t  where   = where_to_send();
 
 #    ifdef BLUETOOTH_ENABLE
     if (where == OUTPUT_BLUETOOTH || where == OUTPUT_USB_AND_BT) {
@@ -645,7 +662,7 @@ static void send_mouse(report_mouse_t *report) {
     /* Select the Mouse Report Endpoint */
     Endpoint_SelectEndpoint(MOUSE_IN_EPNUM);
 
-    /* Check if write ready for a polling interval around 10ms */
+    /* Check if write ready within the polling interval */
     while (timeout-- && !Endpoint_IsReadWriteAllowed()) _delay_us(40);
     if (!Endpoint_IsReadWriteAllowed()) return;
 
@@ -663,14 +680,14 @@ static void send_mouse(report_mouse_t *report) {
  */
 #ifdef EXTRAKEY_ENABLE
 static void send_extra(uint8_t report_id, uint16_t data) {
-    uint8_t timeout = 255;
+    uint16_t timeout = REPORT_SEND_TIMEOUT(SHARED_POLLING_INTERVAL_MS);
 
     if (USB_DeviceState != DEVICE_STATE_Configured) return;
 
     report_extra_t r = {.report_id = report_id, .usage = data};
     Endpoint_SelectEndpoint(SHARED_IN_EPNUM);
 
-    /* Check if write ready for a polling interval around 10ms */
+    /* Check if write ready within the polling interval */
     while (timeout-- && !Endpoint_IsReadWriteAllowed()) _delay_us(40);
     if (!Endpoint_IsReadWriteAllowed()) return;
 
@@ -874,7 +891,13 @@ void virtser_task(void) {
  *
  * FIXME: Needs doc
  */
-void virtser_send(const uint8_t byte) {
+void virtser_send(const uint8_t byte) { virtser_send_buffer(&byte, 1); }
+
+/** \brief Virtual Serial Send Buffer
+ *
+ * Writes all of data before flushing, so that it goes out in as few packets as possible.
+ */
+void virtser_send_buffer(const uint8_t *data, uint8_t length) {
     uint8_t timeout = 255;
     uint8_t ep      = Endpoint_GetCurrentEndpoint();
 
@@ -889,7 +912,7 @@ void virtser_send(const uint8_t byte) {
 
         while (timeout-- && !Endpoint_IsReadWriteAllowed()) _delay_us(40);
 
-        Endpoint_Write_8(byte);
+        Endpoint_Write_Stream_LE(data, length, NULL);
         CDC_Device_Flush(&cdc_device);
 
         if (Endpoint_IsINReady()) {
@@ -0,0 +1,78 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "report_queue.h"
+#include <string.h>
+
+#define REPORT_QUEUE_MASK (REPORT_QUEUE_LENGTH - 1)
+
+// head and tail are free-running, so head - tail is the number of queued
+// reports even after they wrap. The other side's index is loaded with acquire
+// and our own is stored with release, so a slot is never seen as filled (or
+// free) before its contents have been written (or read).
+static inline uint8_t load_index(uint8_t *index) { return __atomic_load_n(index, __ATOMIC_ACQUIRE); }
+
+static inline void store_index(uint8_t *index, uint8_t value) { __atomic_store_n(index, value, __ATOMIC_RELEASE); }
+
+void report_queue_init(report_queue_t *queue) {
+    queue->head      = 0;
+    queue->tail      = 0;
+    queue->in_flight = false;
+}
+
+uint8_t report_queue_free(report_queue_t *queue) { return REPORT_QUEUE_LENGTH - (uint8_t)(queue->head - load_index(&queue->tail)); }
+
+bool report_queue_push(report_queue_t *queue, const void *report, uint8_t length) {
+    if (length > REPORT_QUEUE_REPORT_SIZE || report_queue_free(queue) == 0) {
+        return false;
+    }
+
+    report_queue_entry_t *entry = &queue->entries[queue->head & REPORT_QUEUE_MASK];
+    memcpy(entry->data, report, length);
+    entry->length = length;
+    store_index(&queue->head, queue->head + 1);
+    return true;
+}
+
+/*
+ * Returns the next report to transmit, or NULL if the queue is empty or the
+ * previous report has not been completed yet.
+ */
+const report_queue_entry_t *report_queue_start(report_queue_t *queue) {
+    if (queue->in_flight || report_queue_is_empty(queue)) {
+        return NULL;
+    }
+
+    queue->in_flight = true;
+    return &queue->entries[queue->tail & REPORT_QUEUE_MASK];
+}
+
+// Retires the report handed out by report_queue_start(), if there is one
+void report_queue_complete(report_queue_t *queue) {
+    if (!queue->in_flight) {
+        return;
+    }
+
+    queue->in_flight = false;
+    store_index(&queue->tail, queue->tail + 1);
+}
+
+// Drops everything queued, e.g. after the endpoint has been reset
+void report_queue_clear(report_queue_t *queue) {
+    queue->in_flight = false;
+    store_index(&queue->tail, load_index(&queue->head));
+}
+
+bool report_queue_is_empty(report_queue_t *queue) { return load_index(&queue->head) == queue->tail; }
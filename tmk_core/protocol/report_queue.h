@@ -0,0 +1,73 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Single-producer/single-consumer queue of HID reports for one IN endpoint.
+ *
+ * The main loop is the producer: report_queue_push() copies a report into a
+ * free slot and returns straight away. The USB driver is the consumer:
+ * report_queue_start() hands out the oldest report for transmission, and
+ * report_queue_complete() retires it once the IN transfer has finished. The
+ * slot stays untouched while it is being transmitted, so the driver can send
+ * it without copying.
+ *
+ * The producer only writes head and the consumer only writes tail and
+ * in_flight, so neither side needs a lock to access the queue. The consumer
+ * functions must not run concurrently with each other, which holds when they
+ * are only called with the USB interrupt locked out.
+ */
+
+// Number of reports that can be waiting per endpoint, must be a power of two
+#ifndef REPORT_QUEUE_LENGTH
+#    define REPORT_QUEUE_LENGTH 8
+#endif
+
+// Largest report that can be queued, the NKRO report fills a shared endpoint
+#ifndef REPORT_QUEUE_REPORT_SIZE
+#    define REPORT_QUEUE_REPORT_SIZE 32
+#endif
+
+#if (REPORT_QUEUE_LENGTH & (REPORT_QUEUE_LENGTH - 1)) != 0 || REPORT_QUEUE_LENGTH > 128
+#    error "REPORT_QUEUE_LENGTH must be a power of two, no larger than 128"
+#endif
+
+typedef struct {
+    uint8_t length;
+    uint8_t data[REPORT_QUEUE_REPORT_SIZE];
+} report_queue_entry_t;
+
+typedef struct {
+    report_queue_entry_t entries[REPORT_QUEUE_LENGTH];
+    uint8_t              head;       // next slot to fill, owned by the producer
+    uint8_t              tail;       // oldest queued slot, owned by the consumer
+    bool                 in_flight;  // tail is being transmitted
+} report_queue_t;
+
+void report_queue_init(report_queue_t *queue);
+
+// Producer side
+bool    report_queue_push(report_queue_t *queue, const void *report, uint8_t length);
+uint8_t report_queue_free(report_queue_t *queue);
+
+// Consumer side
+const report_queue_entry_t *report_queue_start(report_queue_t *queue);
+void                        report_queue_complete(report_queue_t *queue);
+void                        report_queue_clear(report_queue_t *queue);
+bool                        report_queue_is_empty(report_queue_t *queue);
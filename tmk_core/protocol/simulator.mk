@@ -0,0 +1,13 @@
+SIMULATOR_DIR = protocol/simulator
+
+OPT_DEFS += -DPROTOCOL_SIMULATOR -DNO_PRINT -DNO_DEBUG
+
+# Enough for eeconfig and a full dynamic keymap
+OPT_DEFS += -DEEPROM_SIZE=4096
+
+SRC += $(SIMULATOR_DIR)/main.c \
+	$(SIMULATOR_DIR)/matrix.c \
+	$(SIMULATOR_DIR)/output.c
+
+# Search Path
+VPATH += $(TMK_PATH)/$(SIMULATOR_DIR)
@@ -0,0 +1,169 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "simulator.h"
+#include "host.h"
+#include "keyboard.h"
+#include "timer.h"
+
+/*
+ * Runs the firmware on the build machine, fed by a trace of switch events:
+ *
+ *   # comments and blank lines are ignored
+ *   0 down 0 1       time in ms, then what happens: switch row 0, col 1 closes
+ *   +30 up 0 1       a time starting with + is relative to the previous line
+ *   500 leds 02      the host turns on Caps Lock
+ *
+ * The scan loop runs once per ms of virtual time, so the output is the same on
+ * every run, however fast the machine is.
+ */
+
+#ifndef SIMULATOR_SETTLE_TIME
+#    define SIMULATOR_SETTLE_TIME 1000
+#endif
+
+// From tmk_core/common/test/timer.c
+void advance_time(uint32_t ms);
+
+static uint32_t scans;
+
+static void run_until(uint32_t time) {
+    while (simulator_time() < time) {
+        keyboard_task();
+        advance_time(1);
+        scans++;
+    }
+}
+
+static bool run_line(const char *line, uint32_t *time) {
+    char     time_text[16];
+    char     command[16];
+    int      time_end, command_end;
+    unsigned row, col, leds;
+
+    if (sscanf(line, " %15s%n", time_text, &time_end) != 1 || time_text[0] == '#') {
+        return true;
+    }
+    if (sscanf(line + time_end, " %15s%n", command, &command_end) != 1) {
+        return false;
+    }
+    const char *args = line + time_end + command_end;
+
+    if (time_text[0] == '+') {
+        *time += strtoul(time_text + 1, NULL, 10);
+    } else {
+        *time = strtoul(time_text, NULL, 10);
+    }
+    run_until(*time);
+
+    if (strcmp(command, "down") == 0 || strcmp(command, "up") == 0) {
+        if (sscanf(args, "%u %u", &row, &col) != 2 || row > 0xFF || col > 0xFF) {
+            return false;
+        }
+        if (command[0] == 'd') {
+            simulator_press(row, col);
+        } else {
+            simulator_release(row, col);
+        }
+        simulator_input_event();
+    } else if (strcmp(command, "leds") == 0) {
+        if (sscanf(args, "%x", &leds) != 1 || leds > 0xFF) {
+            return false;
+        }
+        simulator_set_host_leds(leds);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static void usage(const char *name) { fprintf(stderr, "Usage: %s [-q] [-o output] [-t settle_ms] [trace]\n", name); }
+
+int main(int argc, char **argv) {
+    FILE *   input  = stdin;
+    FILE *   output = stdout;
+    uint32_t settle = SIMULATOR_SETTLE_TIME;
+    bool     quiet  = false;
+    int      option;
+
+    while ((option = getopt(argc, argv, "qo:t:")) != -1) {
+        switch (option) {
+            case 'q':
+                quiet = true;
+                break;
+            case 'o':
+                output = fopen(optarg, "w");
+                if (output == NULL) {
+                    perror(optarg);
+                    return 1;
+                }
+                break;
+            case 't':
+                settle = strtoul(optarg, NULL, 10);
+                break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+    if (optind < argc) {
+        input = fopen(argv[optind], "r");
+        if (input == NULL) {
+            perror(argv[optind]);
+            return 1;
+        }
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    simulator_output_init(output);
+    keyboard_setup();
+    host_set_driver(&simulator_driver);
+    keyboard_init();
+    simulator_start();
+
+    char     line[256];
+    unsigned line_number = 0;
+    uint32_t time        = 0;
+    while (fgets(line, sizeof(line), input) != NULL) {
+        line_number++;
+        if (!run_line(line, &time)) {
+            fprintf(stderr, "%u: can't understand \"%s\"\n", line_number, strtok(line, "\r\n"));
+            return 1;
+        }
+    }
+    run_until(time + settle);
+    fflush(output);
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    if (!quiet) {
+        const simulator_stats_t *stats   = simulator_get_stats();
+        double                   elapsed = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+        fprintf(stderr, "%lu ms simulated, %lu scans in %.3f s (%.0f scans/s)\n", (unsigned long)simulator_time(), (unsigned long)scans, elapsed, elapsed > 0 ? scans / elapsed : 0);
+        fprintf(stderr, "%lu reports, %lu LED frames, %lu RGB LEDs sent\n", (unsigned long)stats->reports, (unsigned long)stats->led_frames, (unsigned long)stats->leds_sent);
+        if (stats->measured) {
+            fprintf(stderr, "latency from switch to report: %.1f ms average, %lu ms max, over %lu events\n", (double)stats->latency_sum / stats->measured, (unsigned long)stats->latency_max, (unsigned long)stats->measured);
+        }
+    }
+    return 0;
+}
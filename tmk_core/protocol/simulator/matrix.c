@@ -0,0 +1,55 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <string.h>
+#include "matrix.h"
+#include "simulator.h"
+
+/*
+ * The switches are set by the trace instead of being read from pins. They go
+ * through the keyboard's debounce algorithm like real ones, using the
+ * CUSTOM_MATRIX = lite scanning in matrix_common.c.
+ */
+static matrix_row_t switches[MATRIX_ROWS];
+static bool         changed;
+
+void simulator_press(uint8_t row, uint8_t col) {
+    if (row < MATRIX_ROWS && col < MATRIX_COLS) {
+        switches[row] |= MATRIX_ROW_SHIFTER << col;
+        changed = true;
+    }
+}
+
+void simulator_release(uint8_t row, uint8_t col) {
+    if (row < MATRIX_ROWS && col < MATRIX_COLS) {
+        switches[row] &= ~(MATRIX_ROW_SHIFTER << col);
+        changed = true;
+    }
+}
+
+void matrix_init_custom(void) {
+    memset(switches, 0, sizeof(switches));
+    changed = false;
+}
+
+bool matrix_scan_custom(matrix_row_t current_matrix[]) {
+    if (!changed) {
+        return false;
+    }
+
+    memcpy(current_matrix, switches, sizeof(switches));
+    changed = false;
+    return true;
+}
@@ -0,0 +1,191 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <string.h>
+#include "simulator.h"
+#include "report.h"
+#include "timer.h"
+#include "keycode_config.h"
+#if defined(RGBLIGHT_ENABLE) || defined(RGB_MATRIX_ENABLE)
+#    include "ws2812.h"
+#endif
+#ifdef BACKLIGHT_ENABLE
+#    include "backlight.h"
+#endif
+
+/*
+ * Everything the firmware sends to the host, and every change to the LEDs,
+ * becomes a line of the output trace, prefixed with the time in ms:
+ *
+ *   120 keyboard 02 04 05       modifiers, then the keys that are down
+ *   300 mouse 01 -3 0 0 0       buttons, x, y, vertical and horizontal wheel
+ *   310 system 0082
+ *   320 consumer 00E9
+ *   400 rgb FF0000 00FF00 ...   one color per LED
+ *   500 backlight 3
+ */
+static FILE *            output;
+static uint8_t           host_leds;
+static simulator_stats_t stats;
+static bool              pending;
+static uint32_t          pending_since;
+static uint32_t          origin;
+static bool              started;
+
+static uint8_t keyboard_leds(void);
+static void    send_keyboard(report_keyboard_t *report);
+static void    send_mouse(report_mouse_t *report);
+static void    send_system(uint16_t data);
+static void    send_consumer(uint16_t data);
+
+host_driver_t simulator_driver = {keyboard_leds, send_keyboard, send_mouse, send_system, send_consumer};
+
+// The simulated host always uses the report protocol
+uint8_t keyboard_idle     = 0;
+uint8_t keyboard_protocol = 1;
+
+void simulator_output_init(FILE *trace) {
+    output    = trace;
+    host_leds = 0;
+    pending   = false;
+    started   = false;
+    memset(&stats, 0, sizeof(stats));
+}
+
+/*
+ * Startup can take a while in virtual time, e.g. bootmagic scans the matrix
+ * for a second, so the trace starts counting once it is done. Anything sent
+ * before then is written at 0.
+ */
+void simulator_start(void) {
+    origin  = timer_read32();
+    started = true;
+}
+
+uint32_t simulator_time(void) { return started ? timer_read32() - origin : 0; }
+
+void simulator_set_host_leds(uint8_t leds) { host_leds = leds; }
+
+/*
+ * Latency is measured from a switch changing to the next report. If another
+ * switch changes first, e.g. after a layer key that sends nothing, only the
+ * later one is measured.
+ */
+void simulator_input_event(void) {
+    pending       = true;
+    pending_since = simulator_time();
+}
+
+const simulator_stats_t *simulator_get_stats(void) { return &stats; }
+
+static void report_sent(void) {
+    stats.reports++;
+    if (pending) {
+        uint32_t latency = simulator_time() - pending_since;
+        stats.measured++;
+        stats.latency_sum += latency;
+        if (latency > stats.latency_max) {
+            stats.latency_max = latency;
+        }
+        pending = false;
+    }
+}
+
+static uint8_t keyboard_leds(void) { return host_leds; }
+
+static void send_keyboard(report_keyboard_t *report) {
+    report_sent();
+#ifdef NKRO_ENABLE
+    if (keymap_config.nkro) {
+        fprintf(output, "%lu keyboard %02X", (unsigned long)simulator_time(), report->nkro.mods);
+        for (uint16_t key = 0; key < KEYBOARD_REPORT_BITS * 8; key++) {
+            if (report->nkro.bits[key / 8] & (1 << (key % 8))) {
+                fprintf(output, " %02X", key);
+            }
+        }
+        fputc('\n', output);
+        return;
+    }
+#endif
+    fprintf(output, "%lu keyboard %02X", (unsigned long)simulator_time(), report->mods);
+    for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+        if (report->keys[i]) {
+            fprintf(output, " %02X", report->keys[i]);
+        }
+    }
+    fputc('\n', output);
+}
+
+static void send_mouse(report_mouse_t *report) {
+    report_sent();
+    fprintf(output, "%lu mouse %02X %d %d %d %d\n", (unsigned long)simulator_time(), report->buttons, report->x, report->y, report->v, report->h);
+}
+
+static void send_system(uint16_t data) {
+    report_sent();
+    fprintf(output, "%lu system %04X\n", (unsigned long)simulator_time(), data);
+}
+
+static void send_consumer(uint16_t data) {
+    report_sent();
+    fprintf(output, "%lu consumer %04X\n", (unsigned long)simulator_time(), data);
+}
+
+#if defined(RGBLIGHT_ENABLE) || defined(RGB_MATRIX_ENABLE)
+// Mock of a WS2812 strip. Like the real one, a shorter frame only changes the
+// first LEDs. The strip is written when it has changed, as some callers
+// refresh the LEDs whether or not they have.
+static LED_TYPE strip[SIMULATOR_MAX_LEDS];
+static uint16_t strip_length;
+
+void ws2812_setleds(LED_TYPE *ledarray, uint16_t number_of_leds) {
+    stats.leds_sent += number_of_leds;
+    if (number_of_leds > SIMULATOR_MAX_LEDS) {
+        number_of_leds = SIMULATOR_MAX_LEDS;
+    }
+    size_t size = number_of_leds * sizeof(LED_TYPE);
+    if (number_of_leds <= strip_length && memcmp(strip, ledarray, size) == 0) {
+        return;
+    }
+    memcpy(strip, ledarray, size);
+    if (number_of_leds > strip_length) {
+        strip_length = number_of_leds;
+    }
+
+    stats.led_frames++;
+    fprintf(output, "%lu rgb", (unsigned long)simulator_time());
+    for (uint16_t i = 0; i < strip_length; i++) {
+        fprintf(output, " %02X%02X%02X", strip[i].r, strip[i].g, strip[i].b);
+    }
+    fputc('\n', output);
+}
+#endif
+
+#ifdef BACKLIGHT_ENABLE
+// Mock of the backlight driver
+static int16_t last_backlight_level = -1;
+
+void backlight_init_ports(void) {}
+
+void backlight_set(uint8_t level) {
+    if (level == last_backlight_level) {
+        return;
+    }
+    last_backlight_level = level;
+
+    stats.led_frames++;
+    fprintf(output, "%lu backlight %u\n", (unsigned long)simulator_time(), level);
+}
+#endif
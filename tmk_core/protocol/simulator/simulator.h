@@ -0,0 +1,50 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "host_driver.h"
+
+// Longest LED strip that is simulated, the LEDs after it are ignored
+#ifndef SIMULATOR_MAX_LEDS
+#    define SIMULATOR_MAX_LEDS 256
+#endif
+
+// Virtual matrix
+void simulator_press(uint8_t row, uint8_t col);
+void simulator_release(uint8_t row, uint8_t col);
+
+// Output of the firmware, written to the trace as it happens
+extern host_driver_t simulator_driver;
+
+void     simulator_output_init(FILE *trace);
+void     simulator_start(void);
+uint32_t simulator_time(void);
+void     simulator_set_host_leds(uint8_t leds);
+void     simulator_input_event(void);
+
+typedef struct {
+    uint32_t reports;
+    uint32_t led_frames;
+    uint32_t leds_sent;    // to the RGB LED driver, over all frames
+    uint32_t measured;     // input events followed by a report
+    uint32_t latency_sum;  // in ms, over the measured events
+    uint32_t latency_max;
+} simulator_stats_t;
+
+const simulator_stats_t *simulator_get_stats(void);
@@ -0,0 +1,13 @@
+#pragma once
+
+#include "quantum/color.h"
+
+/* User Interface
+ *
+ * Input:
+ *         ledarray:           An array of GRB data describing the LED colors
+ *         number_of_leds:     The number of LEDs to write
+ *
+ * The simulator writes the colors to its output trace.
+ */
+void ws2812_setleds(LED_TYPE *ledarray, uint16_t number_of_leds);
@@ -0,0 +1,183 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include <thread>
+#include <vector>
+extern "C" {
+#include "report_queue.h"
+}
+
+class ReportQueue : public testing::Test {
+   public:
+    ReportQueue() { report_queue_init(&queue); }
+
+    bool push(uint8_t value, uint8_t length = 8) {
+        std::vector<uint8_t> report(length, value);
+        return report_queue_push(&queue, report.data(), length);
+    }
+
+    // Plays the part of the IN endpoint: sends the next report, and returns
+    // its first byte, or -1 if there was nothing to send
+    int transmit() {
+        const report_queue_entry_t* entry = report_queue_start(&queue);
+        if (entry == nullptr) {
+            return -1;
+        }
+        int value = entry->data[0];
+        report_queue_complete(&queue);
+        return value;
+    }
+
+    report_queue_t queue;
+};
+
+TEST_F(ReportQueue, starts_empty) {
+    EXPECT_TRUE(report_queue_is_empty(&queue));
+    EXPECT_EQ(report_queue_free(&queue), REPORT_QUEUE_LENGTH);
+    EXPECT_EQ(report_queue_start(&queue), nullptr);
+}
+
+TEST_F(ReportQueue, keeps_reports_in_order) {
+    EXPECT_TRUE(push(1));
+    EXPECT_TRUE(push(2, 3));
+    EXPECT_TRUE(push(3, REPORT_QUEUE_REPORT_SIZE));
+
+    const report_queue_entry_t* entry = report_queue_start(&queue);
+    ASSERT_NE(entry, nullptr);
+    EXPECT_EQ(entry->length, 8);
+    EXPECT_EQ(entry->data[0], 1);
+    report_queue_complete(&queue);
+
+    entry = report_queue_start(&queue);
+    ASSERT_NE(entry, nullptr);
+    EXPECT_EQ(entry->length, 3);
+    EXPECT_EQ(entry->data[2], 2);
+    report_queue_complete(&queue);
+
+    entry = report_queue_start(&queue);
+    ASSERT_NE(entry, nullptr);
+    EXPECT_EQ(entry->length, REPORT_QUEUE_REPORT_SIZE);
+    EXPECT_EQ(entry->data[REPORT_QUEUE_REPORT_SIZE - 1], 3);
+    report_queue_complete(&queue);
+
+    EXPECT_TRUE(report_queue_is_empty(&queue));
+}
+
+TEST_F(ReportQueue, rejects_oversized_reports) {
+    EXPECT_FALSE(push(1, REPORT_QUEUE_REPORT_SIZE + 1));
+    EXPECT_TRUE(report_queue_is_empty(&queue));
+}
+
+TEST_F(ReportQueue, reports_full) {
+    for (uint8_t i = 0; i < REPORT_QUEUE_LENGTH; i++) {
+        EXPECT_TRUE(push(i));
+    }
+    EXPECT_EQ(report_queue_free(&queue), 0);
+    EXPECT_FALSE(push(0xFF));
+
+    EXPECT_EQ(transmit(), 0);
+    EXPECT_TRUE(push(0xFF));
+    for (uint8_t i = 1; i < REPORT_QUEUE_LENGTH; i++) {
+        EXPECT_EQ(transmit(), i);
+    }
+    EXPECT_EQ(transmit(), 0xFF);
+    EXPECT_EQ(transmit(), -1);
+}
+
+TEST_F(ReportQueue, holds_the_report_in_flight) {
+    push(1);
+    push(2);
+
+    const report_queue_entry_t* entry = report_queue_start(&queue);
+    ASSERT_NE(entry, nullptr);
+    // The endpoint is still busy with the first report
+    EXPECT_EQ(report_queue_start(&queue), nullptr);
+
+    // Filling the queue must not overwrite the slot being sent
+    while (push(3)) {
+    }
+    EXPECT_EQ(entry->data[0], 1);
+
+    report_queue_complete(&queue);
+    EXPECT_EQ(transmit(), 2);
+}
+
+TEST_F(ReportQueue, ignores_completions_of_other_transfers) {
+    push(1);
+    // e.g. the IN callback for an idle report that was sent bypassing the queue
+    report_queue_complete(&queue);
+    EXPECT_EQ(transmit(), 1);
+}
+
+TEST_F(ReportQueue, clears_pending_reports) {
+    push(1);
+    push(2);
+    report_queue_start(&queue);
+
+    report_queue_clear(&queue);
+    EXPECT_TRUE(report_queue_is_empty(&queue));
+    EXPECT_EQ(report_queue_free(&queue), REPORT_QUEUE_LENGTH);
+
+    push(3);
+    EXPECT_EQ(transmit(), 3);
+}
+
+TEST_F(ReportQueue, wraps_around) {
+    for (int i = 0; i < 1000; i++) {
+        EXPECT_TRUE(push(i & 0xFF, 1 + i % REPORT_QUEUE_REPORT_SIZE));
+        EXPECT_TRUE(push((i + 1) & 0xFF));
+        EXPECT_EQ(transmit(), i & 0xFF);
+        EXPECT_EQ(transmit(), (i + 1) & 0xFF);
+    }
+}
+
+TEST_F(ReportQueue, concurrent_producer_and_consumer) {
+    const uint32_t count = 100000;
+
+    // Every report carries its sequence number, so the consumer can check that
+    // none are lost, repeated or torn
+    std::thread producer([&]() {
+        for (uint32_t i = 0; i < count; i++) {
+            uint8_t report[REPORT_QUEUE_REPORT_SIZE];
+            for (uint8_t j = 0; j < sizeof(report); j++) {
+                report[j] = (uint8_t)(i + j);
+            }
+            while (!report_queue_push(&queue, report, sizeof(report))) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    uint32_t expected = 0;
+    bool     intact   = true;
+    while (expected < count) {
+        const report_queue_entry_t* entry = report_queue_start(&queue);
+        if (entry == nullptr) {
+            std::this_thread::yield();
+            continue;
+        }
+        for (uint8_t j = 0; j < entry->length; j++) {
+            intact &= entry->data[j] == (uint8_t)(expected + j);
+        }
+        report_queue_complete(&queue);
+        expected++;
+    }
+    producer.join();
+
+    EXPECT_TRUE(intact);
+    EXPECT_TRUE(report_queue_is_empty(&queue));
+}
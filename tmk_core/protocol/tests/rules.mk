@@ -0,0 +1,6 @@
+report_queue_SRC :=\
+	$(TMK_PATH)/protocol/tests/report_queue_tests.cpp \
+	$(TMK_PATH)/protocol/report_queue.c
+
+report_queue_INC :=\
+	$(TMK_PATH)/protocol
@@ -125,14 +125,21 @@ const USB_Descriptor_HIDReport_Datatype_t PROGMEM SharedReport[] = {
             HID_RI_REPORT_SIZE(8, 0x03),
             HID_RI_INPUT(8, HID_IOF_CONSTANT),
 
-            // X/Y position (2 bytes)
+            // X/Y position (2 or 4 bytes)
             HID_RI_USAGE_PAGE(8, 0x01),    // Generic Desktop
             HID_RI_USAGE(8, 0x30),         // X
             HID_RI_USAGE(8, 0x31),         // Y
+#    ifdef MOUSE_EXTENDED_REPORT
+            HID_RI_LOGICAL_MINIMUM(16, -32767),
+            HID_RI_LOGICAL_MAXIMUM(16, 32767),
+            HID_RI_REPORT_COUNT(8, 0x02),
+            HID_RI_REPORT_SIZE(8, 0x10),
+#    else
             HID_RI_LOGICAL_MINIMUM(8, -127),
             HID_RI_LOGICAL_MAXIMUM(8, 127),
             HID_RI_REPORT_COUNT(8, 0x02),
             HID_RI_REPORT_SIZE(8, 0x08),
+#    endif
             HID_RI_INPUT(8, HID_IOF_DATA | HID_IOF_VARIABLE | HID_IOF_RELATIVE),
 
             // Vertical wheel (1 byte)
@@ -313,10 +320,6 @@ const USB_Descriptor_Device_t PROGMEM DeviceDescriptor = {
 #    define USB_MAX_POWER_CONSUMPTION 500
 #endif
 
-#ifndef USB_POLLING_INTERVAL_MS
-#    define USB_POLLING_INTERVAL_MS 10
-#endif
-
 /*
  * Configuration descriptors
  */
@@ -369,7 +372,7 @@ const USB_Descriptor_Configuration_t PROGMEM ConfigurationDescriptor = {
         .EndpointAddress        = (ENDPOINT_DIR_IN | KEYBOARD_IN_EPNUM),
         .Attributes             = (EP_TYPE_INTERRUPT | ENDPOINT_ATTR_NO_SYNC | ENDPOINT_USAGE_DATA),
         .EndpointSize           = KEYBOARD_EPSIZE,
-        .PollingIntervalMS      = USB_POLLING_INTERVAL_MS
+        .PollingIntervalMS      = USB_POLLING_INTERVAL(KEYBOARD_POLLING_INTERVAL_MS)
     },
 #endif
 
@@ -409,7 +412,7 @@ const USB_Descriptor_Configuration_t PROGMEM ConfigurationDescriptor = {
         .EndpointAddress        = (ENDPOINT_DIR_IN | RAW_IN_EPNUM),
         .Attributes             = (EP_TYPE_INTERRUPT | ENDPOINT_ATTR_NO_SYNC | ENDPOINT_USAGE_DATA),
         .EndpointSize           = RAW_EPSIZE,
-        .PollingIntervalMS      = 0x01
+        .PollingIntervalMS      = USB_POLLING_INTERVAL(RAW_POLLING_INTERVAL_MS)
     },
     .Raw_OUTEndpoint = {
         .Header = {
@@ -419,7 +422,7 @@ const USB_Descriptor_Configuration_t PROGMEM ConfigurationDescriptor = {
         .EndpointAddress        = (ENDPOINT_DIR_OUT | RAW_OUT_EPNUM),
         .Attributes             = (EP_TYPE_INTERRUPT | ENDPOINT_ATTR_NO_SYNC | ENDPOINT_USAGE_DATA),
         .EndpointSize           = RAW_EPSIZE,
-        .PollingIntervalMS      = 0x01
+        .PollingIntervalMS      = USB_POLLING_INTERVAL(RAW_POLLING_INTERVAL_MS)
     },
 #endif
 
@@ -436,8 +439,14 @@ const USB_Descriptor_Configuration_t PROGMEM ConfigurationDescriptor = {
         .AlternateSetting       = 0x00,
         .TotalEndpoints         = 1,
         .Class                  = HID_CSCP_HIDClass,
+#    ifdef MOUSE_EXTENDED_REPORT
+        // The boot protocol report has 8-bit movement
+        .SubClass               = HID_CSCP_NonBootSubclass,
+        .Protocol               = HID_CSCP_NonBootProtocol,
+#    else
         .SubClass               = HID_CSCP_BootSubclass,
         .Protocol               = HID_CSCP_MouseBootProtocol,
+#    endif
         .InterfaceStrIndex      = NO_DESCRIPTOR
     },
     .Mouse_HID = {
@@ -459,7 +468,7 @@ const USB_Descriptor_Configuration_t PROGMEM ConfigurationDescriptor = {
         .EndpointAddress        = (ENDPOINT_DIR_IN | MOUSE_IN_EPNUM),
         .Attributes             = (EP_TYPE_INTERRUPT | ENDPOINT_ATTR_NO_SYNC | ENDPOINT_USAGE_DATA),
         .EndpointSize           = MOUSE_EPSIZE,
-        .PollingIntervalMS      = USB_POLLING_INTERVAL_MS
+        .PollingIntervalMS      = USB_POLLING_INTERVAL(MOUSE_POLLING_INTERVAL_MS)
     },
 #endif
 
@@ -504,7 +513,7 @@ const USB_Descriptor_Configuration_t PROGMEM ConfigurationDescriptor = {
         .EndpointAddress        = (ENDPOINT_DIR_IN | SHARED_IN_EPNUM),
         .Attributes             = (EP_TYPE_INTERRUPT | ENDPOINT_ATTR_NO_SYNC | ENDPOINT_USAGE_DATA),
         .EndpointSize           = SHARED_EPSIZE,
-        .PollingIntervalMS      = USB_POLLING_INTERVAL_MS
+        .PollingIntervalMS      = USB_POLLING_INTERVAL(SHARED_POLLING_INTERVAL_MS)
     },
 #endif
 
@@ -544,7 +553,7 @@ const USB_Descriptor_Configuration_t PROGMEM ConfigurationDescriptor = {
         .EndpointAddress        = (ENDPOINT_DIR_IN | CONSOLE_IN_EPNUM),
         .Attributes             = (EP_TYPE_INTERRUPT | ENDPOINT_ATTR_NO_SYNC | ENDPOINT_USAGE_DATA),
         .EndpointSize           = CONSOLE_EPSIZE,
-        .PollingIntervalMS      = 0x01
+        .PollingIntervalMS      = USB_POLLING_INTERVAL(CONSOLE_POLLING_INTERVAL_MS)
     },
     .Console_OUTEndpoint = {
         .Header = {
@@ -554,7 +563,7 @@ const USB_Descriptor_Configuration_t PROGMEM ConfigurationDescriptor = {
         .EndpointAddress        = (ENDPOINT_DIR_OUT | CONSOLE_OUT_EPNUM),
         .Attributes             = (EP_TYPE_INTERRUPT | ENDPOINT_ATTR_NO_SYNC | ENDPOINT_USAGE_DATA),
         .EndpointSize           = CONSOLE_EPSIZE,
-        .PollingIntervalMS      = 0x01
+        .PollingIntervalMS      = USB_POLLING_INTERVAL(CONSOLE_POLLING_INTERVAL_MS)
     },
 #endif
 
@@ -776,7 +785,7 @@ const USB_Descriptor_Configuration_t PROGMEM ConfigurationDescriptor = {
         .EndpointAddress        = CDC_NOTIFICATION_EPADDR,
         .Attributes             = (EP_TYPE_INTERRUPT | ENDPOINT_ATTR_NO_SYNC | ENDPOINT_USAGE_DATA),
         .EndpointSize           = CDC_NOTIFICATION_EPSIZE,
-        .PollingIntervalMS      = 0xFF
+        .PollingIntervalMS      = USB_POLLING_INTERVAL(0xFF)
     },
     .CDC_DCI_Interface = {
         .Header = {
@@ -249,5 +249,46 @@ enum usb_endpoints {
 #define CDC_NOTIFICATION_EPSIZE 8
 #define CDC_EPSIZE 16
 
+/* Polling intervals of the HID interrupt endpoints, in milliseconds */
+#ifndef USB_POLLING_INTERVAL_MS
+#    define USB_POLLING_INTERVAL_MS 1
+#endif
+#ifndef KEYBOARD_POLLING_INTERVAL_MS
+#    define KEYBOARD_POLLING_INTERVAL_MS USB_POLLING_INTERVAL_MS
+#endif
+#ifndef MOUSE_POLLING_INTERVAL_MS
+#    define MOUSE_POLLING_INTERVAL_MS USB_POLLING_INTERVAL_MS
+#endif
+#ifndef SHARED_POLLING_INTERVAL_MS
+#    define SHARED_POLLING_INTERVAL_MS USB_POLLING_INTERVAL_MS
+#endif
+#ifndef RAW_POLLING_INTERVAL_MS
+#    define RAW_POLLING_INTERVAL_MS 1
+#endif
+#ifndef CONSOLE_POLLING_INTERVAL_MS
+#    define CONSOLE_POLLING_INTERVAL_MS 1
+#endif
+
+#if USB_POLLING_INTERVAL_MS < 1 || USB_POLLING_INTERVAL_MS > 255
+#    error "USB_POLLING_INTERVAL_MS must be between 1 and 255"
+#endif
+
+/* bInterval of an interrupt endpoint polled every ms milliseconds.
+ * Full-speed devices give the interval in frames (1ms). High-speed devices
+ * give it in 2^(bInterval-1) microframes (125us), so the interval is rounded
+ * down to a power of two. */
+#ifdef USB_HIGH_SPEED
+#    define USB_POLLING_INTERVAL(ms) ((ms) >= 128 ? 11 : (ms) >= 64 ? 10 : (ms) >= 32 ? 9 : (ms) >= 16 ? 8 : (ms) >= 8 ? 7 : (ms) >= 4 ? 6 : (ms) >= 2 ? 5 : 4)
+#    define USB_POLLING_INTERVAL_US(interval) (125UL << ((interval)-1))
+#else
+#    define USB_POLLING_INTERVAL(ms) (ms)
+#    define USB_POLLING_INTERVAL_US(interval) ((interval)*1000UL)
+#endif
+
+/* How long to wait for the host to take a report before giving up on it, in
+ * milliseconds: two polling intervals, but no less than 10ms, as hubs, KVMs
+ * and some hosts poll slower than the descriptor asks for. */
+#define USB_REPORT_SEND_TIMEOUT_MS(ms) ((ms)*2 > 10 ? (ms)*2 : 10)
+
 uint16_t get_usb_descriptor(const uint16_t wValue, const uint16_t wIndex, const void** const DescriptorAddress);
 #endif
@@ -223,6 +223,16 @@ $(foreach LOBJ, $(NO_LTO_OBJ), $(eval $(call NO_LTO,$(LOBJ))))
 
 MOVE_DEP = mv -f $(patsubst %.o,%.td,$@) $(patsubst %.o,%.d,$@)
 
+# Compiles a C or C++ source, $1 is the output folder and $2 the flags
+ifeq ($(strip $(OBJ_CACHE)), yes)
+    OBJ_CACHE_DIR ?= $(BUILD_DIR)/cache
+    OBJ_CACHE_STATS = $(MASTER_OUTPUT)/objcache.txt
+    COMPILE_OBJ = $(TMK_DIR)/objcache.sh $(OBJ_CACHE_DIR) $(OBJ_CACHE_STATS) $1/compiler.txt $@ $< $(patsubst %.o,%.td,$@) $(CC) $2
+    $(shell rm -f $(OBJ_CACHE_STATS))
+else
+    COMPILE_OBJ = $(CC) -c $2 $(GENDEPFLAGS) $< -o $@
+endif
+
 # Add QMK specific flags
 DFU_SUFFIX ?= dfu-suffix
 DFU_SUFFIX_ARGS ?=
@@ -313,20 +323,20 @@ $1_ASFLAGS= $$(ALL_ASFLAGS) $$($1_DEFS) $$($1_INCFLAGS) $$($1_CONFIG_FLAGS)
 $1/%.o : %.c $1/%.d $1/cflags.txt $1/compiler.txt | $(BEGIN)
 	@mkdir -p $$(@D)
 	@$$(SILENT) || printf "$$(MSG_COMPILING) $$<" | $$(AWK_CMD)
-	$$(eval CMD := $$(CC) -c $$($1_CFLAGS) $$(GENDEPFLAGS) $$< -o $$@ && $$(MOVE_DEP))
+	$$(eval CMD := $$(call COMPILE_OBJ,$1,$$($1_CFLAGS)) && $$(MOVE_DEP))
 	@$$(BUILD_CMD)
 
 # Compile: create object files from C++ source files.
 $1/%.o : %.cpp $1/%.d $1/cxxflags.txt $1/compiler.txt | $(BEGIN)
 	@mkdir -p $$(@D)
 	@$$(SILENT) || printf "$$(MSG_COMPILING_CXX) $$<" | $$(AWK_CMD)
-	$$(eval CMD=$$(CC) -c $$($1_CXXFLAGS) $$(GENDEPFLAGS) $$< -o $$@ && $$(MOVE_DEP))
+	$$(eval CMD=$$(call COMPILE_OBJ,$1,$$($1_CXXFLAGS)) && $$(MOVE_DEP))
 	@$$(BUILD_CMD)
 
 $1/%.o : %.cc $1/%.d $1/cxxflags.txt $1/compiler.txt | $(BEGIN)
 	@mkdir -p $$(@D)
 	@$$(SILENT) || printf "$$(MSG_COMPILING_CXX) $$<" | $$(AWK_CMD)
-	$$(eval CMD=$$(CC) -c $$($1_CXXFLAGS) $$(GENDEPFLAGS) $$< -o $$@ && $$(MOVE_DEP))
+	$$(eval CMD=$$(call COMPILE_OBJ,$1,$$($1_CXXFLAGS)) && $$(MOVE_DEP))
 	@$$(BUILD_CMD)
 
 # Assemble: create object files from assembler source files.
@@ -376,6 +386,19 @@ $(DEPS):
 
 $(foreach OUTPUT,$(OUTPUTS),$(eval $(call GEN_OBJRULE,$(OUTPUT))))
 
+ifeq ($(strip $(OBJ_CACHE)), yes)
+# Prints how many objects came from the cache, and adds them to the totals of
+# every build in $(OBJ_CACHE_DIR)/stats.txt
+objcache-report: $(BUILD_DIR)/$(TARGET).elf
+	HITS=$$(grep -c hit $(OBJ_CACHE_STATS) 2>/dev/null); HITS=$${HITS:-0}; \
+	MISSES=$$(grep -c miss $(OBJ_CACHE_STATS) 2>/dev/null); MISSES=$${MISSES:-0}; \
+	TOTAL=$$(($$HITS + $$MISSES)); \
+	if [ $$TOTAL -gt 0 ]; then \
+		$(SILENT) || printf "Object cache: $$HITS of $$TOTAL objects found, $$(($$HITS * 100 / $$TOTAL))%% hit rate\n"; \
+		mkdir -p $(OBJ_CACHE_DIR) && echo "$(TARGET) $$HITS $$MISSES" >> $(OBJ_CACHE_DIR)/stats.txt; \
+	fi
+endif
+
 # Create preprocessed source for use in sending a bug report.
 %.i : %.c | $(BEGIN)
 	$(CC) -E -mmcu=$(MCU) $(CFLAGS) $< -o $@
@@ -430,7 +453,7 @@ $(eval $(foreach OUTPUT,$(OUTPUTS),$(shell mkdir -p $(OUTPUT) 2>/dev/null)))
 
 
 # Listing of phony targets.
-.PHONY : all finish sizebefore sizeafter qmkversion \
+.PHONY : all finish sizebefore sizeafter qmkversion objcache-report \
 gccversion build elf hex eep lss sym coff extcoff \
 clean clean_list debug gdb-config show_path \
 program teensy dfu flip dfu-ee flip-ee dfu-start \
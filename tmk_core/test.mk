@@ -0,0 +1,4 @@
+# Hosted build of a keyboard, used by the simulator
+include $(TMK_PATH)/native.mk
+
+LDFLAGS += -lm